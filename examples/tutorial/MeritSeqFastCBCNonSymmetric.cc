@@ -0,0 +1,139 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/CoordUniformFigureOfMerit.h"
+#include "latticetester/ProductWeights.h"
+#include "latbuilder/Kernel/FunctorAdaptor.h"
+#include "latbuilder/Functor/BernoulliPoly.h"
+#include "latbuilder/Storage.h"
+
+#include "latbuilder/MeritFilterList.h"
+#include "latbuilder/MeritCombiner.h"
+
+#include "latbuilder/MeritSeq/CoordUniformCBC.h"
+#include "latbuilder/MeritSeq/CoordUniformInnerProd.h"
+#include "latbuilder/MeritSeq/CoordUniformInnerProdFast.h"
+#include "latbuilder/GenSeq/CyclicGroup.h"
+#include "latbuilder/GenSeq/Creator.h"
+
+#include "latbuilder/TextStream.h"
+
+#include "Path.h"
+
+#include <boost/math/constants/constants.hpp>
+
+#include <iostream>
+#include <limits>
+
+using namespace LatBuilder;
+using TextStream::operator<<;
+
+template <typename T, typename... ARGS>
+std::unique_ptr<T> unique(ARGS&&... args)
+{ return std::unique_ptr<T>(new T(std::forward<ARGS>(args)...)); }
+
+//! [functor]
+// kernel of the P2 figure of merit plus a multiple of the Bernoulli polynomial of degree 3,
+// which does not take the same value at x and 1 - x
+struct SkewedFunctor {
+   typedef Real value_type;
+   typedef Real result_type;
+
+   bool symmetric() const
+   { return false; }
+
+   static constexpr Compress suggestedCompression()
+   { return Compress::NONE; }
+
+   std::string name() const
+   { return "skewed"; }
+
+   result_type operator()(const value_type& x, uInteger n = 0) const
+   {
+      const Real pi = boost::math::constants::pi<Real>();
+      return 2 * pi * pi * Functor::BernoulliPoly<2>::apply(x) + 4 * pi * Functor::BernoulliPoly<3>::apply(x);
+   }
+};
+
+class SkewedKernel : public Kernel::FunctorAdaptor<SkewedFunctor> {
+public:
+   static constexpr Real CUPower = 2;
+};
+//! [functor]
+
+template<LatticeType LR>
+void setCombiner(MeritFilterList<LR, EmbeddingType::UNILEVEL>&, const SizeParam<LR, EmbeddingType::UNILEVEL>&) {}
+
+template<LatticeType LR>
+void setCombiner(MeritFilterList<LR, EmbeddingType::MULTILEVEL>& filters, const SizeParam<LR, EmbeddingType::MULTILEVEL>& size) 
+{ filters.add(unique<MeritCombiner::SelectLevel<LR>>(size.maxLevel())); }
+
+// CBC construction with the inner products computed by PROD; returns the generating vector
+template <template <LatticeType, EmbeddingType, Compress, PerLevelOrder> class PROD, EmbeddingType L, PerLevelOrder P>
+std::vector<uInteger> search(const Storage<LatticeType::ORDINARY, L, Compress::NONE, P>& storage, const CoordUniformFigureOfMerit<SkewedKernel>& figure, Dimension dimension)
+{
+   typedef GenSeq::CyclicGroup<LatticeType::ORDINARY, Compress::NONE> Coprime;
+   auto genSeq  = GenSeq::Creator<Coprime>::create(storage.sizeParam());
+   auto genSeq0 = GenSeq::Creator<Coprime>::create(SizeParam<LatticeType::ORDINARY, L>(LatticeTraits<LatticeType::ORDINARY>::TrivialModulus));
+
+   auto cbc = MeritSeq::cbc<PROD>(storage, figure);
+
+   MeritFilterList<LatticeType::ORDINARY, L> filters;
+   setCombiner(filters, storage.sizeParam());
+
+   while (cbc.baseLat().dimension() < dimension) {
+      Dimension baseDim = cbc.baseLat().dimension();
+      auto meritSeq = cbc.meritSeq(baseDim == 0 ? genSeq0 : genSeq);
+      auto filteredSeq = filters.apply(meritSeq);
+      auto best = std::min_element(filteredSeq.begin(), filteredSeq.end());
+      cbc.select(best.base());
+      std::cout << "  " << cbc.baseLat() << "  merit value: " << *best << std::endl;
+   }
+   return std::vector<uInteger>(cbc.baseLat().gen().begin(), cbc.baseLat().gen().end());
+}
+
+template <EmbeddingType L, PerLevelOrder P>
+void test(const Storage<LatticeType::ORDINARY, L, Compress::NONE, P>& storage, Dimension dimension)
+{
+   auto weights = unique<LatticeTester::ProductWeights>();
+   weights->setWeightForCoordinate(0, 0.9);
+   weights->setWeightForCoordinate(1, 0.6);
+   weights->setWeightForCoordinate(2, 0.3);
+
+   //! [figure]
+   CoordUniformFigureOfMerit<SkewedKernel> figure(std::move(weights));
+   //! [figure]
+   std::cout << "figure of merit: " << figure << std::endl;
+
+   std::cout << "CBC:" << std::endl;
+   const auto slow = search<MeritSeq::CoordUniformInnerProd>(storage, figure, dimension);
+   std::cout << "fast CBC:" << std::endl;
+   const auto fast = search<MeritSeq::CoordUniformInnerProdFast>(storage, figure, dimension);
+   std::cout << "same generating vector: " << (slow == fast ? "yes" : "no") << std::endl;
+}
+
+int main()
+{
+   SET_PATH_TO_LATNETBUILDER_FOR_EXAMPLES();
+   Dimension dim = 3;
+
+   //! [storage]
+   test(Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::NONE>(256), dim);
+   test(Storage<LatticeType::ORDINARY, EmbeddingType::MULTILEVEL, Compress::NONE, PerLevelOrder::CYCLIC>(256), dim);
+   //! [storage]
+
+   return 0;
+}
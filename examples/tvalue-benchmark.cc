@@ -0,0 +1,140 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the boost::dynamic_bitset representation of generating matrices (GeneratingMatrix)
+// with the word-packed representation (PackedGeneratingMatrix) on the row reductions performed
+// by the t-value computations, and times the t-value computations for m = 20, ..., 32.
+
+#include "netbuilder/GeneratingMatrix.h"
+#include "netbuilder/PackedGeneratingMatrix.h"
+#include "netbuilder/FigureOfMerit/TValueComputation.h"
+#include "latbuilder/LFSR258.h"
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace NetBuilder;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// random m x m matrices with one word per row
+std::vector<GeneratingMatrix> randomMatrices(unsigned int dimension, unsigned int m, LatBuilder::LFSR258& rng)
+{
+    std::vector<GeneratingMatrix> res;
+    for (unsigned int coord = 0; coord < dimension; ++coord)
+    {
+        std::vector<GeneratingMatrix::uInteger> rows(m);
+        for (auto& row : rows)
+        {
+            row = rng() & ((1UL << m) - 1);
+        }
+        res.emplace_back(m, m, rows);
+    }
+    return res;
+}
+
+// rank of the rows stacked below each other, using boost::dynamic_bitset rows
+unsigned int rankWithBitsets(std::vector<GeneratingMatrix::Row> rows, unsigned int nCols)
+{
+    unsigned int rank = 0;
+    for (unsigned int j = 0; j < nCols && rank < rows.size(); ++j)
+    {
+        unsigned int i = rank;
+        while (i < rows.size() && !rows[i][j]) { ++i; }
+        if (i == rows.size()) { continue; }
+        std::swap(rows[i], rows[rank]);
+        for (unsigned int l = rank + 1; l < rows.size(); ++l)
+        {
+            if (rows[l][j]) { rows[l] ^= rows[rank]; }
+        }
+        ++rank;
+    }
+    return rank;
+}
+
+// rank of the rows stacked below each other, using word-packed rows
+unsigned int rankWithWords(PackedGeneratingMatrix rows)
+{
+    unsigned int rank = 0;
+    for (unsigned int j = 0; j < rows.nCols() && rank < rows.nRows(); ++j)
+    {
+        unsigned int i = rank;
+        while (i < rows.nRows() && !rows(i, j)) { ++i; }
+        if (i == rows.nRows()) { continue; }
+        rows.swapRows(i, rank);
+        for (unsigned int l = rank + 1; l < rows.nRows(); ++l)
+        {
+            if (rows(l, j)) { rows.xorRow(l, rank); }
+        }
+        ++rank;
+    }
+    return rank;
+}
+
+template <typename FUNC>
+double timeInMicroseconds(FUNC&& func, unsigned int nRepetitions)
+{
+    auto start = Clock::now();
+    for (unsigned int r = 0; r < nRepetitions; ++r)
+    {
+        func();
+    }
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / nRepetitions;
+}
+
+int main()
+{
+    const unsigned int dimension = 3;
+    const unsigned int nRepetitions = 200;
+    LatBuilder::LFSR258 rng;
+
+    std::cout << "m\trank-bitset(us)\trank-packed(us)\tspeedup\tt-value\tgauss(us)" << std::endl;
+    for (unsigned int m = 20; m <= 32; ++m)
+    {
+        auto matrices = randomMatrices(dimension, m, rng);
+
+        std::vector<GeneratingMatrix::Row> bitsetRows;
+        PackedGeneratingMatrix packedRows(0, m);
+        for (const auto& mat : matrices)
+        {
+            for (unsigned int i = 0; i < m; ++i)
+            {
+                bitsetRows.push_back(mat[i]);
+            }
+            packedRows.stackBelow(PackedGeneratingMatrix(mat));
+        }
+
+        unsigned int rank1 = 0, rank2 = 0;
+        double bitsetTime = timeInMicroseconds([&](){ rank1 = rankWithBitsets(bitsetRows, m); }, nRepetitions);
+        double packedTime = timeInMicroseconds([&](){ rank2 = rankWithWords(packedRows); }, nRepetitions);
+        if (rank1 != rank2)
+        {
+            std::cerr << "rank mismatch for m = " << m << std::endl;
+            return 1;
+        }
+
+        unsigned int tValue = 0;
+        double gaussTime = timeInMicroseconds([&](){ tValue = GaussMethod::computeTValue(matrices, 0, 0); }, 1);
+
+        std::cout << m << '\t'
+            << std::fixed << std::setprecision(2) << bitsetTime << '\t' << packedTime << '\t'
+            << bitsetTime / packedTime << '\t' << tValue << '\t'
+            << gaussTime << std::endl;
+    }
+    return 0;
+}
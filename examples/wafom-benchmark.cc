@@ -0,0 +1,156 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the evaluation of the WAFOM with one table lookup per segment through GetColsReverseCache::compute_d_c
+// and LookUpTable::get, and with one std::pow per bit, with the block kernel LookUpTable::multiplyFactors used by
+// the evaluators, and reports the number of evaluations per second for m = 20 and s = 10.
+
+#include "netbuilder/Types.h"
+#include "netbuilder/DigitalNet.h"
+#include "netbuilder/FigureOfMerit/Wafom/GetColsReverseCache.h"
+#include "netbuilder/FigureOfMerit/Wafom/FastWafom.h"
+#include "netbuilder/FigureOfMerit/Wafom/Wafom.h"
+#include "latbuilder/Functor/LookUpTable.h"
+#include "latbuilder/LFSR258.h"
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+using namespace NetBuilder;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+// random net with w x m generating matrices
+DigitalNet<NetConstruction::EXPLICIT> randomNet(Dimension dimension, unsigned int w, unsigned int m, LatBuilder::LFSR258& rng)
+{
+    std::vector<GeneratingMatrix> matrices;
+    for (Dimension coord = 0; coord < dimension; ++coord)
+    {
+        std::vector<GeneratingMatrix::uInteger> rows(w);
+        for (auto& row : rows)
+        {
+            row = rng() & ((1UL << m) - 1);
+        }
+        matrices.emplace_back(w, m, rows);
+    }
+    return DigitalNet<NetConstruction::EXPLICIT>(dimension, {w, m}, matrices);
+}
+
+// WAFOM with one table lookup per segment
+double wafomWithSegmentLookups(const AbstractDigitalNet& net, const LookUpTable& table, uInteger q)
+{
+    const uInteger w = net.numRows();
+    const int dim = net.dimension();
+    GetColsReverseCache cache(net);
+    std::vector<uint64_t> point(dim);
+    double sum = 0.0;
+    for (uInteger i = 0; i < net.numPoints(); ++i)
+    {
+        cache.getPoint(i, dim, point.data());
+        double product = 1.0;
+        for (int j = 0; j < dim; ++j)
+        {
+            for (uInteger c = 1; c <= q + (w % q != 0 ? 1 : 0); ++c)
+            {
+                product *= table.get(c, cache.compute_d_c(point[j], c, w, q));
+            }
+        }
+        sum += product - 1.0;
+    }
+    return sum / net.numPoints();
+}
+
+// WAFOM with one std::pow per bit
+double wafomWithPow(const AbstractDigitalNet& net, double h, double factor)
+{
+    const int w = net.numRows();
+    const int dim = net.dimension();
+    GetColsReverseCache cache(net);
+    std::vector<uint64_t> point(dim);
+    double sum = 0.0;
+    for (uInteger i = 0; i < net.numPoints(); ++i)
+    {
+        cache.getPoint(i, dim, point.data());
+        double product = 1.0;
+        for (int j = 0; j < dim; ++j)
+        {
+            for (int l = 1; l <= w; ++l)
+            {
+                int bit = (point[j] >> (w - l)) & 1;
+                product *= (1 + (1 - 2 * bit) * std::pow(2.0, -(factor * (l + h))));
+            }
+        }
+        sum += product - 1.0;
+    }
+    return sum / net.numPoints();
+}
+
+template <typename FUNC>
+double evaluationsPerSecond(FUNC&& func, unsigned int nRepetitions)
+{
+    auto start = Clock::now();
+    for (unsigned int r = 0; r < nRepetitions; ++r)
+    {
+        func();
+    }
+    return nRepetitions / std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+int main()
+{
+    const Dimension dimension = 10;
+    const unsigned int m = 20;
+    const unsigned int w = 30;
+    const unsigned int q = 3;
+    const double h = 1;
+    const double factor = 1;
+    const unsigned int nRepetitions = 5;
+
+    LatBuilder::LFSR258 rng;
+    auto net = randomNet(dimension, w, m, rng);
+    LookUpTable table(w, q, w / q, h, factor);
+
+    FigureOfMerit::FastWafom fastWafom(q, w, table);
+    auto fastEvaluator = fastWafom.evaluator();
+    FigureOfMerit::Wafom wafom(h, factor);
+    auto wafomEvaluator = wafom.evaluator();
+
+    double lookupMerit = 0, kernelMerit = 0, powMerit = 0, bitTableMerit = 0;
+    double lookupRate = evaluationsPerSecond([&](){ lookupMerit = wafomWithSegmentLookups(net, table, q); }, nRepetitions);
+    double kernelRate = evaluationsPerSecond([&](){ kernelMerit = (*fastEvaluator)(net); }, nRepetitions);
+    double powRate = evaluationsPerSecond([&](){ powMerit = wafomWithPow(net, h, factor); }, 1);
+    double bitTableRate = evaluationsPerSecond([&](){ bitTableMerit = (*wafomEvaluator)(net); }, 1);
+
+    // the evaluators sum the points by chunks with compensated sums (see PointSum), so the last bits may differ
+    auto close = [](double a, double b) { return std::abs(a - b) <= 1e-12 * std::abs(a); };
+    if (!close(lookupMerit, kernelMerit) || !close(powMerit, bitTableMerit))
+    {
+        std::cerr << "merit mismatch" << std::endl;
+        return 1;
+    }
+
+    std::cout << "m = " << m << ", s = " << dimension << ", w = " << w << ", q = " << q << std::endl;
+    std::cout << "method\t\tevaluations/s\tmerit" << std::endl;
+    std::cout << std::setprecision(6)
+        << "segment lookups\t" << lookupRate << "\t\t" << lookupMerit << std::endl
+        << "block kernel\t" << kernelRate << "\t\t" << kernelMerit << std::endl
+        << "std::pow\t" << powRate << "\t\t" << powMerit << std::endl
+        << "bit table\t" << bitTableRate << "\t\t" << bitTableMerit << std::endl;
+    return 0;
+}
@@ -2,7 +2,10 @@
 #define LATBUILDER__FUNCTOR__LOOKUPTABLE_H
 #include <vector>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <stdexcept>
+
 /**
  * This class computes the Walsh Figure of Merit (WAFOM) for a Digital Net in
  * Base 2 using a lookup table to accelerate the computation.
@@ -55,6 +58,14 @@
  *
  * We use Kahan summation algorithm improves numerical accuracy by compensating
  * for floating-point errors, reducing round-off error accumulation.
+ *
+ * The shift, the mask and the offset in the table of each segment are
+ * precomputed, so that multiplyFactors() can process blocks of points without
+ * branches nor bound checks. With GCC on x86-64 Linux, a version which processes
+ * four points at once with AVX2 gathers from the tables is selected at runtime
+ * on the processors which support it. Each product is computed in
+ * the same order as with get(), so that the results do not depend on the code
+ * path.
  **/
 class LookUpTable
 {
@@ -89,8 +100,19 @@ public:
         lookupTable.resize(tableSize);
 
         generate();
+        generateSegments();
     }
 
+    /**
+     * Returns the number of bits of the coordinates of the points.
+     */
+    int numBits() const { return n; }
+
+    /**
+     * Returns the number of segments of the coordinates, including the remainder segment, if any.
+     */
+    int numSegments() const { return (int)shifts.size(); }
+
     double get(int c, int e) const
     {
         if (c == 0 || c > q + (n % q != 0 ? 1 : 0))
@@ -104,10 +126,24 @@ public:
         return lookupTable[index(c, e)];
     }
 
+    /**
+     * Multiplies <CODE>products[p]</CODE> by the product of the table values of the segments of <CODE>points[p * stride]</CODE>,
+     * for <CODE>p = 0, ..., numPoints - 1</CODE>. The coordinates must have numBits() bits.
+     * The segments are processed in the order of their indices, as with get().
+     * @param points Coordinates of the points.
+     * @param numPoints Number of points.
+     * @param stride Distance between the coordinates of two consecutive points in \c points.
+     * @param products Products to update.
+     */
+    void multiplyFactors(const uint64_t *points, std::size_t numPoints, std::size_t stride, double *products) const;
+
 private:
     int q;
     int l;
     std::vector<double> lookupTable;
+    std::vector<int> shifts;       // for each segment, shift which brings the segment to the least significant bits
+    std::vector<uint64_t> masks;   // for each segment, mask of the bits of the segment after the shift
+    std::vector<uint64_t> offsets; // for each segment, index in lookupTable of the values of the segment
     double h;
     double factor;
     int n;
@@ -144,6 +180,22 @@ private:
         }
     }
 
+    void generateSegments()
+    {
+        for (int c = 1; c <= q; ++c)
+        {
+            shifts.push_back(n - c * l);
+            masks.push_back((uint64_t(1) << l) - 1);
+            offsets.push_back(index(c, 0));
+        }
+        if (n % q != 0)
+        {
+            shifts.push_back(0);
+            masks.push_back((uint64_t(1) << (n % q)) - 1);
+            offsets.push_back(index(q + 1, 0));
+        }
+    }
+
     double computeProduct(int c, int e, int length) const
     {
         double product = 1.0;
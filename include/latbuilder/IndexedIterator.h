@@ -79,6 +79,12 @@ private:
    void increment()
    { ++m_index; updateValue(); }
 
+   void decrement()
+   { --m_index; updateValue(); }
+
+   void advance(ptrdiff_t n)
+   { m_index += n; updateValue(); }
+
    bool equal(const Forward& other) const
    { return m_seq == other.m_seq and index() == other.index(); }
 
@@ -0,0 +1,152 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+/**
+ * \file
+ * Allocation of large vectors in memory-mapped files when they do not fit in
+ * a memory budget.
+ */
+
+#ifndef LATBUILDER__MAPPED_MEMORY_H
+#define LATBUILDER__MAPPED_MEMORY_H
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace LatBuilder {
+
+/**
+ * Memory for the state vectors of the coordinate-uniform CBC algorithm.
+ *
+ * The blocks are allocated in RAM as long as the total size of the blocks
+ * allocated in RAM does not exceed the budget set with setBudget().  The other
+ * blocks are mapped to temporary files, created in the directory set with
+ * setDirectory() and removed immediately, so that the operating system pages
+ * them to and from the disk instead of the swap.  The blocks are accessed
+ * sequentially by chunks (see MeritSeq::StateChunkSize), which suits the read
+ * ahead of memory-mapped files on local disks.
+ *
+ * By default, the budget is unlimited and all the blocks are allocated in RAM.
+ * Memory-mapped files are available on POSIX systems only; elsewhere, the
+ * budget is ignored.
+ */
+class MappedMemory {
+public:
+   /// Value of the budget for which all the blocks are allocated in RAM.
+   static constexpr size_t Unlimited = size_t(-1);
+
+   /**
+    * Sets the maximal total size, in bytes, of the blocks allocated in RAM.
+    * The blocks allocated before the call are not moved.
+    */
+   static void setBudget(size_t bytes);
+
+   /**
+    * Returns the maximal total size, in bytes, of the blocks allocated in RAM.
+    */
+   static size_t budget();
+
+   /**
+    * Sets the directory where the memory-mapped files are created.
+    * If empty (default), the directory given by the \c TMPDIR environment
+    * variable is used, or \c /tmp if it is not set.
+    */
+   static void setDirectory(std::string directory);
+
+   /**
+    * Returns the directory where the memory-mapped files are created.
+    */
+   static std::string directory();
+
+   /**
+    * Returns the total size, in bytes, of the blocks currently allocated in RAM.
+    */
+   static size_t residentSize();
+
+   /**
+    * Returns the total size, in bytes, of the blocks currently mapped to files.
+    */
+   static size_t mappedSize();
+
+   /**
+    * Allocates a block of \c bytes bytes.
+    * Throws \c std::bad_alloc if a block within the budget cannot be allocated
+    * in RAM, and \c std::runtime_error if a block beyond the budget cannot be
+    * mapped to a file.
+    */
+   static void* allocate(size_t bytes);
+
+   /**
+    * Frees a block returned by allocate().
+    */
+   static void deallocate(void* block, size_t bytes);
+};
+
+/**
+ * Standard allocator that allocates its blocks with MappedMemory.
+ */
+template <typename T>
+class MappedAllocator {
+public:
+   typedef T value_type;
+   typedef T* pointer;
+   typedef const T* const_pointer;
+   typedef T& reference;
+   typedef const T& const_reference;
+   typedef size_t size_type;
+   typedef std::ptrdiff_t difference_type;
+
+   template <typename U>
+   struct rebind { typedef MappedAllocator<U> other; };
+
+   MappedAllocator() = default;
+
+   template <typename U>
+   MappedAllocator(const MappedAllocator<U>&)
+   {}
+
+   T* allocate(size_t n)
+   { return static_cast<T*>(MappedMemory::allocate(n * sizeof(T))); }
+
+   void deallocate(T* p, size_t n)
+   { MappedMemory::deallocate(p, n * sizeof(T)); }
+
+   size_t max_size() const
+   { return size_t(-1) / sizeof(T); }
+
+   template <typename U, typename... ARGS>
+   void construct(U* p, ARGS&&... args)
+   { ::new (static_cast<void*>(p)) U(std::forward<ARGS>(args)...); }
+
+   template <typename U>
+   void destroy(U* p)
+   { p->~U(); }
+};
+
+template <typename T, typename U>
+bool operator==(const MappedAllocator<T>&, const MappedAllocator<U>&)
+{ return true; }
+
+template <typename T, typename U>
+bool operator!=(const MappedAllocator<T>&, const MappedAllocator<U>&)
+{ return false; }
+
+}
+
+#endif
@@ -80,6 +80,32 @@ public:
       m_baseMerit = storage().createMeritValue(0.0);
    }
 
+   /**
+    * State of the CBC algorithm after the selection of the first components
+    * of the generating vector.
+    */
+   struct Checkpoint {
+      LatDef baseLat;
+      MeritValue baseMerit;
+   };
+
+   /**
+    * Returns the current state of the CBC algorithm.
+    *
+    * \sa #restore()
+    */
+   Checkpoint checkpoint() const
+   { return Checkpoint{m_baseLat, m_baseMerit}; }
+
+   /**
+    * Restores a state returned by #checkpoint().
+    */
+   void restore(const Checkpoint& checkpoint)
+   {
+      m_baseLat = checkpoint.baseLat;
+      m_baseMerit = checkpoint.baseMerit;
+   }
+
    /**
     * Returns the storage configuration instance.
     */
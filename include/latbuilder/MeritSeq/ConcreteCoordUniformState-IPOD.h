@@ -98,7 +98,7 @@ private:
    RealVector m_elemPolySum;
    RealVector m_partialWeightedState;
    RealVector m_waitingKernelValues;
-   std::vector<RealVector> m_state;
+   std::vector<StateVector> m_state;
 };
 
 
@@ -124,7 +124,7 @@ private:
 
    RealVector m_elemPolySum; // equals the left sum in the formula for the weighted state q
    RealVector m_partialWeightedState; // equals the right sum in the formula for the weighted state q
-   std::vector<RealVector> m_state;
+   std::vector<StateVector> m_state;
 };
 
 
@@ -150,7 +150,7 @@ private:
 
    RealVector m_elemPolySum; // equals the left sum in the formula for the weighted state q
    RealVector m_partialWeightedState; // equals the right sum in the formula for the weighted state q
-   std::vector<RealVector> m_state;
+   std::vector<StateVector> m_state;
 };
 
 
@@ -22,6 +22,7 @@
 
 #include "latticetester/OrderDependentWeights.h"
 
+#include <limits>
 #include <vector>
 
 namespace LatBuilder { namespace MeritSeq {
@@ -29,6 +30,26 @@ namespace LatBuilder { namespace MeritSeq {
 // forward declaration
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class WEIGHTS> class ConcreteCoordUniformState;
 
+/**
+ * Returns the number of state vectors \f$\boldsymbol p_{s,\ell}\f$ that must be kept
+ * to compute \f$\sum_\ell \Gamma_{\ell+1} \boldsymbol p_{s,\ell}\f$ for the
+ * order-dependent weights \f$\Gamma_\ell\f$, that is, the maximal order with a nonzero
+ * weight (but at least 1, for order 0).
+ * If the default weight is nonzero, all orders are kept and the maximal value of
+ * \c std::size_t is returned.
+ */
+inline std::size_t numOrdersToKeep(const LatticeTester::OrderDependentWeights& weights)
+{
+   if (weights.getDefaultWeight() != 0.0)
+      return std::numeric_limits<std::size_t>::max();
+   std::size_t maxOrder = 1;
+   for (std::size_t order = 1; order < weights.getSize(); order++) {
+      if (weights.getWeightForOrder(order) != 0.0)
+         maxOrder = order;
+   }
+   return maxOrder;
+}
+
 
 /**
  * Implementation of CoordUniformState for order-dependent weights.
@@ -58,6 +79,11 @@ template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO
  *    \boldsymbol p_{s,\ell} =
  *       \boldsymbol p_{s-1,\ell} + \boldsymbol\omega_s \odot \boldsymbol p_{s-1,\ell-1}.
  * \f]
+ *
+ * If \f$\Gamma_\ell = 0\f$ for all \f$\ell > q\f$, only the vectors
+ * \f$\boldsymbol p_{s,\ell}\f$ for \f$0 \leq \ell < q\f$ are kept and updated
+ * (see numOrdersToKeep()), so that the memory and the update time are in
+ * \f$O(qn)\f$ instead of \f$O(sn)\f$.
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 class ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::OrderDependentWeights> :
@@ -118,8 +144,11 @@ public:
 private:
    const LatticeTester::OrderDependentWeights& m_weights;
 
+   // number of orders kept in m_state
+   std::size_t m_numOrders;
+
    // m_state[level](i)
-   std::vector<RealVector> m_state;
+   std::vector<StateVector> m_state;
 };
 
 extern template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::NONE, PerLevelOrder::BASIC,      LatticeTester::OrderDependentWeights>;
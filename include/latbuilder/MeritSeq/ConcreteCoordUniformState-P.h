@@ -115,7 +115,7 @@ private:
    const LatticeTester::ProductWeights& m_weights;
 
    // m_state(i)
-   RealVector m_state;
+   StateVector m_state;
 };
 
 
@@ -132,7 +132,7 @@ private:
 
    // m_state[projection](i)
    // declared mutable because it is updated transparently by #getStateVector()
-   std::map<LatticeTester::Coordinates, RealVector> m_state;
+   std::map<LatticeTester::Coordinates, StateVector> m_state;
 
    // keep track of the selected generator values to be able to generate state
    // vectors on demand
@@ -144,7 +144,7 @@ private:
     *
     * \return A reference to the state vector.
     */
-   const RealVector& createStateVector(const LatticeTester::Coordinates& projection, const RealVector& kernelValues);
+   const StateVector& createStateVector(const LatticeTester::Coordinates& projection, const RealVector& kernelValues);
 };
 
 
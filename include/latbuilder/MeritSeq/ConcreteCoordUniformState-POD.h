@@ -18,6 +18,7 @@
 #define LATBUILDER__MERIT_SEQ__CONCRETE_COORD_SYM_STATE_POD_H
 
 #include "latbuilder/MeritSeq/CoordUniformState.h"
+#include "latbuilder/MeritSeq/ConcreteCoordUniformState-OD.h"
 #include "latbuilder/Storage.h"
 
 #include "latticetester/PODWeights.h"
@@ -31,6 +32,9 @@ template <LatticeType LR, EmbeddingType ET, Compress COMPRESS , PerLevelOrder PL
 
 /**
  * Implementation of CoordUniformState for POD weights.
+ *
+ * Only the orders that have a nonzero order-dependent weight are kept in the
+ * state (see numOrdersToKeep()).
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 class ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::PODWeights> :
@@ -91,8 +95,11 @@ public:
 private:
    const LatticeTester::PODWeights& m_weights;
 
+   // number of orders kept in m_state
+   std::size_t m_numOrders;
+
    // m_state[level](i)
-   std::vector<RealVector> m_state;
+   std::vector<StateVector> m_state;
 };
 
 
@@ -21,6 +21,7 @@
 #include "latbuilder/MeritSeq/CoordUniformInnerProd.h"
 #include "latbuilder/MeritSeq/CoordUniformState.h"
 #include "latbuilder/MeritSeq/CoordUniformStateCreator.h"
+#include "latbuilder/MeritSeq/StateKernels.h"
 
 #include "latbuilder/LatDef.h"
 #include "latbuilder/Storage.h"
@@ -99,6 +100,36 @@ public:
          state->reset();
    }
 
+   /**
+    * State of the CBC algorithm after the selection of the first components
+    * of the generating vector.
+    */
+   struct Checkpoint {
+      LatDef baseLat;
+      MeritValue baseMerit;
+      StateList states;
+   };
+
+   /**
+    * Returns the current state of the CBC algorithm.
+    *
+    * The states are copied.
+    *
+    * \sa #restore()
+    */
+   Checkpoint checkpoint() const
+   { return Checkpoint{m_baseLat, m_baseMerit, m_states}; }
+
+   /**
+    * Restores a state returned by #checkpoint().
+    */
+   void restore(const Checkpoint& checkpoint)
+   {
+      m_baseLat = checkpoint.baseLat;
+      m_baseMerit = checkpoint.baseMerit;
+      m_states = checkpoint.states;
+   }
+
    /**
     * Returns the storage configuration instance.
     */
@@ -128,13 +159,9 @@ public:
     */
    RealVector weightedState() const
    {
-      auto it = states().begin();
-      if (it == states().end())
+      if (states().empty())
          throw std::runtime_error("CoordUniformCBC: empty list of states");
-      auto out = (*it)->weightedState();
-      while (++it != states().end())
-         out += (*it)->weightedState();
-      return out;
+      return sumWeightedStates(states());
    }
 
    //! \copydoc CBC::baseLat()
@@ -0,0 +1,414 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LATBUILDER__MERIT_SEQ__INNER_PROD_FAST_OLR_H
+#define LATBUILDER__MERIT_SEQ__INNER_PROD_FAST_OLR_H
+
+#include "latbuilder/MeritSeq/CoordUniformInnerProdFast.h"
+#include "latbuilder/GenSeq/CyclicGroup.h"
+#include "latbuilder/GenSeq/CoprimeIntegers.h"
+#include "latbuilder/GenSeq/GeneratingValues.h"
+#include "latbuilder/CompressTraits.h"
+#include "latbuilder/Util.h"
+
+#include <algorithm>
+#include <complex>
+#include <mutex>
+
+namespace LatBuilder { namespace MeritSeq {
+
+namespace detail {
+   template <class GENSEQ>
+   struct IsCoprimeSeq
+   { static constexpr bool value = IsFastCompatible<GENSEQ>::value; };
+
+   template <Compress COMPRESS, class TRAV>
+   struct IsCoprimeSeq<GenSeq::GeneratingValues<LatticeType::ORDINARY, COMPRESS, TRAV>>
+   { static constexpr bool value = true; };
+
+   template <Compress COMPRESS, class TRAV>
+   struct IsCoprimeSeq<GenSeq::CoprimeIntegers<COMPRESS, TRAV>>
+   { static constexpr bool value = true; };
+}
+
+/**
+ * FFT-based implementation of the inner product for ordinary lattice rules
+ * with an arbitrary number of points \f$n\f$.
+ *
+ * The point indices \f$k \in \mathbb Z_n\f$ are partitioned according to
+ * \f$\gcd(k, n)\f$: for each divisor \f$d\f$ of \f$n\f$, the indices \f$k\f$
+ * with \f$\gcd(k, n) = n/d\f$ are the \f$(n/d) u\f$ for \f$u\f$ in the group
+ * of units \f$U_d\f$, and the component of \f$k z\f$ for a generator value
+ * \f$z\f$ coprime with \f$n\f$ only depends on \f$u z \bmod d\f$.  The
+ * contribution of each block to the inner product is thus a correlation over
+ * \f$U_d\f$.  By the Chinese remainder theorem, \f$U_d\f$ is the direct
+ * product of the groups \f$U_{p^e}\f$ for the prime powers \f$p^e\f$ that
+ * divide \f$d\f$, which are cyclic except for \f$U_{2^e} = \{\pm 1\} \times
+ * \langle 5 \rangle\f$ with \f$e \geq 3\f$.  Indexing the elements of
+ * \f$U_d\f$ with their exponents with respect to the generators of these
+ * cyclic factors turns the correlation into a multidimensional circular
+ * correlation, which is computed with a multidimensional FFT.  FFTW handles
+ * the factors of arbitrary order, including large prime orders, in
+ * \f$O(\varphi(d) \log \varphi(d))\f$ operations.  This generalizes the
+ * algorithm of \cite rCOO06a for prime powers \f$n\f$.
+ *
+ * The inner products for all generator values are computed at once, then
+ * looked up by generator value, so that any sequence of generator values
+ * coprime with \f$n\f$ can be used.  As for the levels of embedded lattices,
+ * the blocks are transformed concurrently, largest first, in work buffers
+ * which are kept from one computation to the next.
+ */
+template <Compress COMPRESS, PerLevelOrder PLO>
+class CoordUniformInnerProdFast<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS, PLO> {
+
+protected:
+   typedef typename fftw<Real>::real_vector FFTRealVector;
+   typedef typename fftw<Real>::complex_vector FFTComplexVector;
+   typedef typename fftw<Real>::shape_type FFTShape;
+
+public:
+   typedef Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS, PerLevelOrder::BASIC> InternalStorage;
+   typedef CoordUniformStateList<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS, PerLevelOrder::BASIC> StateList;
+   typedef typename Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS, PLO>::MeritValue MeritValue;
+
+   /**
+    * Constructor.
+    *
+    * \param storage       Storage configuration.
+    * \param kernel        Kernel.  Used to create a sequence of
+    *                      permuatations of the kernel values evaluated at every
+    *                      one-dimensional lattice point.
+    */
+   template <class K>
+   CoordUniformInnerProdFast(
+         Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS, PLO> storage,
+         const Kernel::Base<K>& kernel
+         ):
+      m_storage(std::move(storage)),
+      m_internalStorage(this->storage().sizeParam()),
+      m_kernelValues(kernel.valuesVector(this->internalStorage())),
+      m_blocks(computeBlocks())
+   {}
+
+   /**
+    * Returns the storage configuration instance.
+    */
+   const Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS, PLO>& storage() const
+   { return m_storage; }
+
+   /**
+    * Returns the internal storage configuration instance.
+    */
+   const InternalStorage& internalStorage() const
+   { return m_internalStorage; }
+
+   /**
+    * Returns the vector of kernel values.
+    */
+   const RealVector& kernelValues() const
+   { return m_kernelValues; }
+
+private:
+   /**
+    * Block of point indices \f$(n/d) U_d\f$ associated with a divisor \f$d\f$
+    * of the modulus \f$n\f$.
+    */
+   struct Block {
+      /// Common divisor \f$n/d\f$ of the indices of the block.
+      uInteger stride;
+      /// Orders of the nontrivial cyclic factors of \f$U_d\f$.
+      FFTShape shape;
+      /// Elements of \f$U_d\f$, ordered by exponents in row-major order.
+      std::vector<uInteger> elements;
+      /// FFT of the kernel values on the block.
+      FFTComplexVector kernelFFT;
+   };
+
+   /**
+    * Work buffers for the transforms of a block.
+    */
+   struct BlockBuffers {
+      /// Values of the vector on the block, then of the correlation.
+      FFTRealVector real;
+      /// FFT of the values of the vector, then of the correlation.
+      FFTComplexVector spectrum;
+   };
+
+   /**
+    * Work buffers of all blocks, allocated on first use and reused by the
+    * following calls of computeProdValues().  Copies of the inner product do
+    * not share their buffers.
+    */
+   struct Workspace {
+      std::mutex mutex;
+      std::vector<BlockBuffers> blocks;
+
+      Workspace() = default;
+      Workspace(const Workspace&) {}
+      Workspace& operator=(const Workspace&) { return *this; }
+   };
+
+   template <class E>
+   RealVector computeProdValues(
+         const boost::numeric::ublas::vector_expression<E>& ve
+         ) const
+   {
+      const auto& vec = ve();
+      const auto modulus = internalStorage().sizeParam().modulus();
+
+      RealVector out(internalStorage().size(), 0.0);
+
+      std::lock_guard<std::mutex> lock(m_workspace.mutex);
+      if (m_workspace.blocks.empty()) {
+         m_workspace.blocks.resize(m_blocks.size());
+         for (size_t b = 0; b < m_blocks.size(); b++) {
+            m_workspace.blocks[b].real.resize(m_blocks[b].elements.size());
+            m_workspace.blocks[b].spectrum.resize(m_blocks[b].kernelFFT.size());
+         }
+      }
+
+      // the blocks are independent and sorted by decreasing size
+      Parallel::forEach(m_blocks.size(), [&](size_t b) {
+            const auto& block = m_blocks[b];
+            auto& buffers = m_workspace.blocks[b];
+
+            // gather the vector values on the block
+            for (size_t i = 0; i < block.elements.size(); i++)
+               buffers.real[i] = vec(CompressTraits<COMPRESS>::compressIndex(block.stride * block.elements[i], modulus));
+
+            // correlate with the kernel values in Fourier space
+            transform(block.shape, buffers.real, buffers.spectrum);
+            for (size_t i = 0; i < buffers.spectrum.size(); i++)
+               buffers.spectrum[i] = std::conj(buffers.spectrum[i]) * block.kernelFFT[i];
+            inverseTransform(block.shape, buffers.spectrum, buffers.real);
+            });
+
+      // the value at u contributes to all generator values z = u mod d
+      for (size_t b = 0; b < m_blocks.size(); b++) {
+         const auto& block = m_blocks[b];
+         const auto& rvec = m_workspace.blocks[b].real;
+         const uInteger d = modulus / block.stride;
+         for (size_t i = 0; i < block.elements.size(); i++)
+            for (uInteger z = block.elements[i]; z < out.size(); z += d)
+               out[z] += rvec[i];
+      }
+
+      return out;
+   }
+
+public:
+   /**
+    * Sequence of inner product values.
+    *
+    * \tparam GENSEQ    Type of sequence of generator values.  Its values must be
+    *                   coprime with the modulus.
+    */
+   template <class GENSEQ>
+   class Seq :
+      public BridgeSeq<
+         Seq<GENSEQ>,                           // self type
+         GENSEQ,                                // base type
+         MeritValue,                            // value type
+         BridgeIteratorCached> {
+
+      static_assert(
+            detail::IsCoprimeSeq<GENSEQ>::value,
+            "generator sequence is not compatible with fast product");
+   public:
+
+      typedef GENSEQ GenSeq;
+      typedef typename Seq::Base Base;
+      typedef typename Seq::size_type size_type;
+
+      /**
+       * Constructor.
+       *
+       * \param parent     Parent inner product instance.
+       * \param genSeq     Sequence of generator sequences that determines the
+       *                   order of the permutations of \c baseVec.
+       * \param vec        Second operand in the inner product.
+       */
+      template <class E>
+      Seq(
+            const CoordUniformInnerProdFast& parent,
+            GenSeq genSeq,
+            const boost::numeric::ublas::vector_expression<E>& vec
+            ):
+         Seq::BridgeSeq_(std::move(genSeq)),
+         m_parent(parent),
+         m_values(parent.computeProdValues(vec()))
+      {}
+
+      /**
+       * Returns the parent inner product of this sequence.
+       */
+      const CoordUniformInnerProdFast& innerProd() const
+      { return m_parent; }
+
+      MeritValue element(const typename Base::const_iterator& it) const
+      {
+         const auto modulus = m_parent.internalStorage().sizeParam().modulus();
+         return m_values[CompressTraits<COMPRESS>::compressIndex(*it % modulus, modulus)];
+      }
+
+   private:
+      const CoordUniformInnerProdFast& m_parent;
+      RealVector m_values;
+   };
+
+   /**
+    * Creates a new sequence of inner product values by applying a stride
+    * permutation based on \c genSeq to the vector of kernel values, then by
+    * computing the inner product with \c vec.
+    *
+    * \param genSeq     Sequence of generator values.
+    * \param vec        Second operand in the inner product.
+    */
+   template <class GENSEQ, class E>
+   Seq<GENSEQ> prodSeq(
+         const GENSEQ& genSeq,
+         const boost::numeric::ublas::vector_expression<E>& vec
+         ) const
+   { return Seq<GENSEQ>(*this, genSeq, vec); }
+
+private:
+   static void transform(const FFTShape& shape, const FFTRealVector& rvec, FFTComplexVector& cvec)
+   {
+      if (shape.empty())
+         cvec[0] = rvec[0];
+      else
+         fftw<Real>::fft(shape, rvec, cvec);
+   }
+
+   static void inverseTransform(const FFTShape& shape, const FFTComplexVector& cvec, FFTRealVector& rvec)
+   {
+      if (shape.empty())
+         rvec[0] = cvec[0].real();
+      else
+         fftw<Real>::ifft(shape, cvec, rvec, true);
+   }
+
+   /**
+    * Decomposes the point indices into blocks, one for each divisor of the
+    * modulus, and computes the FFT's of the kernel values on each block.
+    */
+   std::vector<Block> computeBlocks() const
+   {
+      typedef GenSeq::CyclicGroup<LatticeType::ORDINARY> CyclicGroup;
+
+      const auto modulus = internalStorage().sizeParam().modulus();
+      const auto factors = primeFactorsMap(modulus);
+
+      std::vector<Block> blocks;
+
+      // enumerate the divisors d through the exponents of their prime factors
+      std::vector<uInteger> exponents(factors.size(), 0);
+      while (true) {
+
+         uInteger d = 1;
+         {
+            auto itExp = exponents.begin();
+            for (const auto& factor : factors)
+               d *= intPow(factor.first, *itExp++);
+         }
+
+         Block block;
+         block.stride = modulus / d;
+         block.elements.assign(1, 1 % d);
+
+         // add the cyclic factors of U_{p^e} for each prime power dividing d
+         auto itExp = exponents.begin();
+         for (const auto& factor : factors) {
+            const auto p = factor.first;
+            const auto e = *itExp++;
+            if (e == 0)
+               continue;
+            const auto pe = intPow(p, e);
+
+            // generators modulo p^e and their orders
+            std::vector<std::pair<uInteger, uInteger>> generators;
+            if (p != 2)
+               generators.emplace_back(CyclicGroup::smallestGenerator(p, e, false), pe / p * (p - 1));
+            else {
+               if (e >= 2)
+                  generators.emplace_back(pe - 1, 2);
+               if (e >= 3)
+                  generators.emplace_back(5, pe / 4);
+            }
+
+            // element of Z_d congruent to 1 modulo p^e and to 0 modulo d / p^e
+            const auto m = d / pe;
+            long long unit = (long long)(m) * egcd(pe, m).second % (long long)(d);
+            if (unit < 0)
+               unit += d;
+
+            for (const auto& gen : generators) {
+               // generator lifted to Z_d: congruent to 1 modulo d / p^e
+               const uInteger h = (1 + (gen.first - 1) * (uInteger)(unit)) % d;
+               std::vector<uInteger> elements;
+               elements.reserve(block.elements.size() * gen.second);
+               for (const auto& u : block.elements) {
+                  uInteger x = u;
+                  for (uInteger t = 0; t < gen.second; t++) {
+                     elements.push_back(x);
+                     x = x * h % d;
+                  }
+               }
+               block.elements = std::move(elements);
+               block.shape.push_back(static_cast<int>(gen.second));
+            }
+         }
+
+         // FFT of the kernel values on the block
+         FFTRealVector rvec(block.elements.size());
+         for (size_t i = 0; i < rvec.size(); i++)
+            rvec[i] = kernelValues()(CompressTraits<COMPRESS>::compressIndex(block.stride * block.elements[i], modulus));
+         block.kernelFFT.resize(fftw<Real>::fft_size(block.shape));
+         transform(block.shape, rvec, block.kernelFFT);
+
+         blocks.push_back(std::move(block));
+
+         // next divisor
+         size_t j = 0;
+         auto itFactor = factors.begin();
+         while (j < exponents.size() and exponents[j] == itFactor->second) {
+            exponents[j++] = 0;
+            ++itFactor;
+         }
+         if (j == exponents.size())
+            break;
+         exponents[j]++;
+      }
+
+      // largest blocks first, for the concurrent transforms
+      std::stable_sort(blocks.begin(), blocks.end(), [](const Block& a, const Block& b) {
+            return a.elements.size() > b.elements.size();
+            });
+
+      return blocks;
+   }
+
+private:
+   Storage<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS, PLO> m_storage;
+   InternalStorage m_internalStorage;
+   RealVector m_kernelValues;
+   std::vector<Block> m_blocks;
+   mutable Workspace m_workspace;
+};
+
+}}
+
+#endif
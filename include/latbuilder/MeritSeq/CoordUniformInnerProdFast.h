@@ -23,12 +23,14 @@
 #include "latbuilder/Storage.h"
 #include "latbuilder/CachedSeq.h"
 #include "latbuilder/IndexMap.h"
+#include "latbuilder/Parallel.h"
 #include "latbuilder/fftw++.h"
 
 #include <boost/numeric/ublas/expression_types.hpp>
 #include <boost/numeric/ublas/vector_proxy.hpp>
 
 #include <memory>
+#include <mutex>
 #include <vector>
 
 namespace LatBuilder { namespace MeritSeq {
@@ -48,9 +50,16 @@ namespace detail {
  * vector with a single vector.
  *
  * Implemented for integer powers of prime bases, as proposed in \cite rCOO06a .
+ * In base 2 without compression, each level consists of two circulant
+ * half-blocks, as in the Stride permutation of the embedded storage, and the
+ * products are computed with two transforms of half length per level.
+ * For (simple) ordinary lattice rules, the specialization in
+ * CoordUniformInnerProdFast-OLR.h supports an arbitrary number of points.
  *
  * Computes the inner product with a second vector for all vectors in the
- * sequence at once.
+ * sequence at once.  The levels are transformed concurrently (see
+ * Parallel::setNumThreads()), largest first, in work buffers which are kept
+ * from one computation to the next.
  */
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
 class CoordUniformInnerProdFast {
@@ -109,10 +118,13 @@ public:
    { return m_levelRanges; }
 
    /**
-    * Returns the FFT's of the first column of each circulant submatrix in the
-    * horizontal block-circulant matrix.
+    * Returns, for each level, the FFT's of the first column of each circulant
+    * submatrix in the horizontal block-circulant matrix.
+    *
+    * There is a single circulant block per level, except in base 2 without
+    * compression, where there are two circulant half-blocks per level.
     */
-   const std::vector<FFTComplexVector>& circulantFFT() const
+   const std::vector<std::vector<FFTComplexVector>>& circulantFFT() const
    { return m_circulantFFT; }
 
 
@@ -125,74 +137,165 @@ private:
       return out;
    }
 
-   template <class E>
-   RealVector computeProdValues(
-         const boost::numeric::ublas::vector_expression<E>& ve
-         ) const
+   /**
+    * Returns the number of circulant blocks on the level with range \c range.
+    *
+    * In base 2, the group of units modulo \f$2^m\f$ is not cyclic for \f$m
+    * \geq 3\f$, so that without compression, each level with at least two
+    * elements is split into two circulant half-blocks (see Cools et al.
+    * (2006)): the half-block of the elements \f$g^{-i}\f$ and that of the
+    * elements \f$-g^{-i}\f$.
+    */
+   size_t numCirculantBlocks(const boost::numeric::ublas::range& range) const
    {
-      if(LR == LatticeType::ORDINARY){
-        // in base 2, on each level, we have 2 circulant half-blocks instead of
-        // a single circulant block
-        if (not internalStorage().symmetric() and internalStorage().sizeParam().base() == 2)
-           throw std::logic_error("not implemented for non-symmetric vectors in base 2");
-       }
+      if (LR == LatticeType::ORDINARY) {
+         if (not internalStorage().symmetric() and internalStorage().sizeParam().base() == 2 and range.size() >= 2)
+            return 2;
+      }
+      return 1;
+   }
 
-      const auto& vec = ve();
-      using namespace boost::numeric::ublas;
+   /**
+    * Returns the index, on a level split into \c numBlocks circulant blocks of
+    * size \c blockSize, of the product value for the generator on row \c row
+    * of half-block \c block.
+    */
+   static size_t levelIndex(size_t numBlocks, size_t blockSize, size_t block, size_t row)
+   { return (numBlocks == 2 ? block * blockSize : 0) + row % blockSize; }
+
+   /**
+    * Work buffers for the transforms of a level.
+    */
+   struct LevelBuffers {
+      /// Values of one circulant block of the vector, then of the products.
+      FFTRealVector real;
+      /// FFT of each circulant block of the vector.
+      std::vector<FFTComplexVector> spectra;
+      /// Products in Fourier space.
+      FFTComplexVector product;
+   };
 
-      auto itRange = levelRanges().begin();
-      auto itRangePrev = itRange;
-      auto itCirculantFFT = circulantFFT().begin();
+   /**
+    * Work buffers of all levels, allocated on first use and reused by the
+    * following calls of computeProdValues().  Copies of the inner product do
+    * not share their buffers.
+    */
+   struct Workspace {
+      std::mutex mutex;
+      std::vector<LevelBuffers> levels;
 
-      RealVector out(vec.size());
+      Workspace() = default;
+      Workspace(const Workspace&) {}
+      Workspace& operator=(const Workspace&) { return *this; }
+   };
+
+   /**
+    * Allocates the work buffers of the levels, if not already done.
+    */
+   void allocateBuffers() const
+   {
+      if (not m_workspace.levels.empty())
+         return;
+      m_workspace.levels.resize(levelRanges().size());
+      for (size_t level = 0; level < levelRanges().size(); level++) {
+         auto& buffers = m_workspace.levels[level];
+         const size_t numBlocks = circulantFFT()[level].size();
+         const size_t blockSize = levelRanges()[level].size() / numBlocks;
+         buffers.real.resize(blockSize);
+         buffers.spectra.assign(numBlocks, FFTComplexVector(fftw<Real>::fft_size(buffers.real)));
+         buffers.product.resize(fftw<Real>::fft_size(buffers.real));
+      }
+   }
 
-      while (itRange != levelRanges().end()) {
+   /**
+    * Computes the products on level \c level of the circulant blocks with
+    * the vector \c vec, and stores them in \c out.
+    */
+   void computeLevelProdValues(size_t level, const RealVector& vec, RealVector& out) const
+   {
+      using namespace boost::numeric::ublas;
 
-         if (itCirculantFFT == circulantFFT().end())
-            throw std::logic_error("circulant FFT's have too few levels");
+      const auto& range = levelRanges()[level];
+      const auto& circulant = circulantFFT()[level];
+      auto& buffers = m_workspace.levels[level];
 
-         // select vector range
-         vector_range<const RealVector> subvec(vec, *itRange);
+      const size_t numBlocks = circulant.size();
+      const size_t blockSize = range.size() / numBlocks;
 
-         // convert to FFT-compatible vectors
-         FFTRealVector rvec(subvec.begin(), subvec.end());
+      // select vector range
+      vector_range<const RealVector> subvec(vec, range);
 
-         // compute FFT
-         FFTComplexVector cvec = fftw<Real>::fft(rvec);
+      // compute FFT of each block of the vector
+      for (size_t block = 0; block < numBlocks; block++) {
+         std::copy(subvec.begin() + block * blockSize, subvec.begin() + (block + 1) * blockSize, buffers.real.begin());
+         fftw<Real>::fft(buffers.real, buffers.spectra[block]);
+      }
 
-         // ratio of the number or natural elements to the number of internal
-         // elements, multiplied by normalization
-         size_t compressionRatio = 1;
-         if(LR == LatticeType::ORDINARY){
-           if (internalStorage().symmetric() and (itRange - levelRanges().begin()) >= (internalStorage().sizeParam().base() == 2 ? 2 : 1)) {
-              // compressionRatio except if uncompressed level has only one element
-              compressionRatio = 2;
-           }
-         }
+      // ratio of the number or natural elements to the number of internal
+      // elements, multiplied by normalization
+      size_t compressionRatio = 1;
+      if(LR == LatticeType::ORDINARY){
+        if (internalStorage().symmetric() and level >= (internalStorage().sizeParam().base() == 2 ? 2 : 1)) {
+           // compressionRatio except if uncompressed level has only one element
+           compressionRatio = 2;
+        }
+      }
 
-         // multiply in Fourier space
-         for (size_t i = 0; i < cvec.size(); i++)
-            cvec[i] *= compressionRatio * (*itCirculantFFT)[i];
+      for (size_t outBlock = 0; outBlock < numBlocks; outBlock++) {
+
+         // multiply in Fourier space; with two half-blocks, the generators
+         // of the second half-block exchange the roles of the kernel
+         // half-blocks
+         std::fill(buffers.product.begin(), buffers.product.end(), Real(0));
+         for (size_t block = 0; block < numBlocks; block++) {
+            const auto& kernel = circulant[outBlock ^ block];
+            const auto& spectrum = buffers.spectra[block];
+            for (size_t i = 0; i < buffers.product.size(); i++)
+               buffers.product[i] += Real(compressionRatio) * kernel[i] * spectrum[i];
+         }
 
          // inverse transform
-         fftw<Real>::ifft(cvec, rvec, true);
+         fftw<Real>::ifft(buffers.product, buffers.real, true);
 
          // export to the output vector
-         std::copy(rvec.begin(), rvec.end(), &out[itRange->start()]);
-
-         // add contributions from lower levels
-         if (itRange != itRangePrev) {
-            typedef typename vector_range<RealVector>::size_type size_type;
-            vector_range<RealVector> curLevel(out, *itRange);
-            vector_range<const RealVector> prevLevel(out, *itRangePrev);
-            for (size_type i = 0; i < curLevel.size(); i++)
-               curLevel[i] += prevLevel[i % prevLevel.size()];
-         }
+         std::copy(buffers.real.begin(), buffers.real.end(), &out[range.start() + outBlock * blockSize]);
+      }
+   }
+
+   template <class E>
+   RealVector computeProdValues(
+         const boost::numeric::ublas::vector_expression<E>& ve
+         ) const
+   {
+      const auto& vec = ve();
+      using namespace boost::numeric::ublas;
+
+      if (circulantFFT().size() < levelRanges().size())
+         throw std::logic_error("circulant FFT's have too few levels");
 
-         itRangePrev = itRange;
+      RealVector out(vec.size());
 
-         ++itCirculantFFT;
-         ++itRange;
+      {
+         std::lock_guard<std::mutex> lock(m_workspace.mutex);
+         allocateBuffers();
+
+         // the levels are independent; the higher levels are the largest
+         const size_t numLevels = levelRanges().size();
+         Parallel::forEach(numLevels, [&](size_t task) {
+               computeLevelProdValues(numLevels - 1 - task, vec, out);
+               });
+      }
+
+      // add contributions from lower levels
+      for (size_t level = 1; level < levelRanges().size(); level++) {
+         typedef typename vector_range<RealVector>::size_type size_type;
+         vector_range<RealVector> curLevel(out, levelRanges()[level]);
+         vector_range<const RealVector> prevLevel(out, levelRanges()[level - 1]);
+         const size_t blockSize = curLevel.size() / circulantFFT()[level].size();
+         const size_t prevNumBlocks = circulantFFT()[level - 1].size();
+         const size_t prevBlockSize = prevLevel.size() / prevNumBlocks;
+         for (size_type i = 0; i < curLevel.size(); i++)
+            curLevel[i] += prevLevel[levelIndex(prevNumBlocks, prevBlockSize, i / blockSize, i % blockSize)];
       }
 
       return out;
@@ -249,14 +352,20 @@ public:
 
       MeritValue element(const typename Base::const_iterator& it) const
       {
+         // in base 2, the generators of the second half of the group are
+         // those congruent to -1 modulo 4
+         const size_t block = LatticeTraits<LR>::ToIndex(*it) % 4 == 3 ? 1 : 0;
+
          RealVector mlMerit(m_parent.levelRanges().size());
          for (
                auto itRange = m_parent.levelRanges().begin();
                itRange != m_parent.levelRanges().end();
                ++itRange
                ) {
+            const auto level = itRange - m_parent.levelRanges().begin();
+            const size_t numBlocks = m_parent.circulantFFT()[level].size();
             boost::numeric::ublas::vector_range<const RealVector> curLevel(m_values, *itRange);
-            mlMerit[itRange - m_parent.levelRanges().begin()] = curLevel[(it - it.seq().begin()) % curLevel.size()];
+            mlMerit[level] = curLevel[levelIndex(numBlocks, curLevel.size() / numBlocks, block, it - it.seq().begin())];
          }
 
          MeritValue merit = m_parent.storage().createMeritValue(0.0);
@@ -296,11 +405,11 @@ private:
     * Computes the FFT's of the first column of each circulant submatrix in the
     * horizontal block-circulant matrix.
     */
-   std::vector<FFTComplexVector> computeCirculantFFT() const
+   std::vector<std::vector<FFTComplexVector>> computeCirculantFFT() const
    {
       const auto ranges = levelRanges();
 
-      std::vector<FFTComplexVector> result(ranges.size());
+      std::vector<std::vector<FFTComplexVector>> result(ranges.size());
 
       for (
             auto itRange = ranges.begin();
@@ -308,21 +417,29 @@ private:
             ++itRange
             ) {
 
-         // select level
-         boost::numeric::ublas::vector_range<const RealVector> lvec(
-               kernelValues(),
-               *itRange
-               );
+         const size_t numBlocks = numCirculantBlocks(*itRange);
+         const size_t blockSize = itRange->size() / numBlocks;
+
+         for (size_t block = 0; block < numBlocks; block++) {
 
-         // apply circulant-transpose
-         const auto tvec = circulantTranspose(lvec);
+            // select circulant block
+            boost::numeric::ublas::vector_range<const RealVector> lvec(
+                  kernelValues(),
+                  boost::numeric::ublas::range(
+                     itRange->start() + block * blockSize,
+                     itRange->start() + (block + 1) * blockSize)
+                  );
 
-         // convert to FFT-compatible vectors
-         FFTRealVector rvec(tvec.begin(), tvec.begin() + tvec.size());
+            // apply circulant-transpose
+            const auto tvec = circulantTranspose(lvec);
 
-         // compute FFT
-         result[itRange - ranges.begin()] =
-            fftw<Real>::fft(rvec);
+            // convert to FFT-compatible vectors
+            FFTRealVector rvec(tvec.begin(), tvec.begin() + tvec.size());
+
+            // compute FFT
+            result[itRange - ranges.begin()].push_back(
+               fftw<Real>::fft(rvec));
+         }
       }
 
       return result;
@@ -364,10 +481,13 @@ private:
    InternalStorage m_internalStorage;
    RealVector m_kernelValues;
    std::vector<boost::numeric::ublas::range> m_levelRanges;
-   std::vector<FFTComplexVector> m_circulantFFT;
+   std::vector<std::vector<FFTComplexVector>> m_circulantFFT;
+   mutable Workspace m_workspace;
 };
 
 
 }}
 
+#include "latbuilder/MeritSeq/CoordUniformInnerProdFast-OLR.h"
+
 #endif
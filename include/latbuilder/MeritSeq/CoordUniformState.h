@@ -19,11 +19,21 @@
 
 #include "latbuilder/Types.h"
 #include "latbuilder/Storage.h"
+#include "latbuilder/MappedMemory.h"
 
 #include <memory>
 
 namespace LatBuilder { namespace MeritSeq {
 
+/**
+ * Vector type of the state vectors kept by the implementations of
+ * CoordUniformState.
+ *
+ * Their memory is allocated with MappedMemory, so that the state vectors
+ * that do not fit in the memory budget are kept in memory-mapped files.
+ */
+typedef boost::numeric::ublas::vector<Real, boost::numeric::ublas::unbounded_array<Real, MappedAllocator<Real>>> StateVector;
+
 /**
  * Base base class for states used in the evaluation coordinate-uniform
  * figures of merit.
@@ -20,10 +20,16 @@
 #include "latbuilder/BridgeSeq.h"
 #include "latbuilder/BridgeIteratorCached.h"
 #include "latbuilder/Traversal.h"
+#include "latbuilder/Functor/AllOf.h"
+
+#include <boost/signals2.hpp>
 
 #include <type_traits>
 #include <functional>
+#include <limits>
 #include <memory>
+#include <stdexcept>
+#include <vector>
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -34,6 +40,12 @@ namespace LatBuilder { namespace MeritSeq {
  * by applying the CBC algorithm for each component, but considering only the
  * current generator value instead of all values from a sequence of generator
  * values like in the original CBC algorithm. 
+ *
+ * The states of the CBC algorithm after the selection of the first components
+ * of the last generating vector are kept, so that only the components which
+ * differ from the previous generating vector are processed.  This is most
+ * effective for sequences which enumerate generating vectors in lexicographic
+ * order, like Cartesian products of sequences of generator values.
  * 
  * \tparam CBC		Type of CBC algorithm.
  */
@@ -43,18 +55,36 @@ class LatSeqOverCBC
    typedef LatSeqOverCBC<CBC> self_type;
 
 public:
+   typedef typename CBC::MeritValue MeritValue;
+   typedef boost::signals2::signal<bool (const MeritValue&), Functor::AllOf> OnProgress;
+
    /**
     * Constructor.
     *
     * \param cbc  Instance of the CBC algorithm to be used.
     */
    LatSeqOverCBC(CBC cbc):
-      m_cbc(new CBC(std::move(cbc)))
+      m_cbc(new CBC(std::move(cbc))),
+      m_onProgress(new OnProgress)
    {}
 
    const CBC& cbc() const
    { return *m_cbc; }
 
+   /**
+    * Progress signal.
+    *
+    * Emitted when the merit value of the first components of a generating
+    * vector is known.  The signal argument is that merit value.  If any of the
+    * signal slots returns \c false, the remaining components are not
+    * processed and the merit value of the generating vector is set to
+    * infinity.  As the merit value cannot decrease when components are
+    * appended, this skips all the generating vectors which start with the same
+    * components.
+    */
+   OnProgress& onProgress() const
+   { return *m_onProgress; }
+
    /**
     * Output sequence of merit values.
     *
@@ -80,11 +110,13 @@ public:
        * Constructor.
        *
        * \param cbc        Instance of the CBC algorithm.
+       * \param onProgress Progress signal.
        * \param base       Base lattice sequence.
        */
-      Seq(CBC& cbc, Base base):
+      Seq(CBC& cbc, const OnProgress& onProgress, Base base):
          self_type::BridgeSeq_(std::move(base)),
-         m_cbc(cbc)
+         m_cbc(cbc),
+         m_onProgress(onProgress)
       {}
 
       /**
@@ -93,16 +125,33 @@ public:
        */
       value_type element(const typename Base::const_iterator& it) const
       {
-         m_cbc.reset();
+         const auto& gen = it->gen();
+         const auto& seqIts = it.base().seqIterators();
+
+         // number of first components shared with the previous generating
+         // vector, excluding the last component
+         size_t depth = 0;
+         while (depth < m_prefix.size() and depth + 1 < gen.size() and
+               m_prefix[depth] == gen[depth])
+            ++depth;
+
+         if (m_checkpoints.empty()) {
+            m_cbc.reset();
+            m_checkpoints.push_back(m_cbc.checkpoint());
+         }
+         else {
+            m_cbc.restore(m_checkpoints[depth]);
+         }
+         m_prefix.resize(depth);
+         m_checkpoints.resize(depth + 1);
 
          if (m_cbc.baseLat().sizeParam() != it->sizeParam())
             throw std::logic_error("inconsistent lattice size");
 
-         for (
-               auto genIt = it.base().seqIterators().begin();
-               genIt != it.base().seqIterators().end();
-               ++genIt
-               ) {
+         if (depth > 0 and not m_onProgress(m_cbc.baseMerit()))
+            return m_cbc.storage().createMeritValue(std::numeric_limits<Real>::infinity());
+
+         for (auto genIt = seqIts.begin() + depth; genIt != seqIts.end(); ++genIt) {
 
             // rebind the base generator sequence to a sequence of unit size
             // starting at the current generator index
@@ -110,6 +159,15 @@ public:
                   Traversal::Forward(genIt->index(), 1));
 
             m_cbc.select(m_cbc.meritSeq(genSeq).begin());
+
+            if (genIt + 1 == seqIts.end())
+               break;
+
+            m_prefix.push_back(gen[m_prefix.size()]);
+            m_checkpoints.push_back(m_cbc.checkpoint());
+
+            if (not m_onProgress(m_cbc.baseMerit()))
+               return m_cbc.storage().createMeritValue(std::numeric_limits<Real>::infinity());
          }
 
          return m_cbc.baseMerit();
@@ -117,6 +175,11 @@ public:
 
    private:
       CBC& m_cbc;
+      const OnProgress& m_onProgress;
+      // first components of the last generating vector
+      mutable typename CBC::LatDef::GeneratingVector m_prefix;
+      // states of the CBC algorithm after the selection of each prefix of m_prefix
+      mutable std::vector<typename CBC::Checkpoint> m_checkpoints;
    };
 
    /**
@@ -127,10 +190,11 @@ public:
     */
    template <typename LATSEQ>
    Seq<LATSEQ> meritSeq(LATSEQ latSeq) const
-   { return Seq<LATSEQ>(*m_cbc, std::move(latSeq)); }
+   { return Seq<LATSEQ>(*m_cbc, *m_onProgress, std::move(latSeq)); }
 
 private:
    std::unique_ptr<CBC> m_cbc;
+   std::unique_ptr<OnProgress> m_onProgress;
 };
 
 /// Creates a search algorithm on top of a CBC algorithm.
@@ -0,0 +1,145 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#ifndef LATBUILDER__MERIT_SEQ__STATE_KERNELS_H
+#define LATBUILDER__MERIT_SEQ__STATE_KERNELS_H
+
+#include "latbuilder/Types.h"
+#include "latbuilder/Parallel.h"
+
+#include <vector>
+
+namespace LatBuilder { namespace MeritSeq {
+
+/**
+ * Number of consecutive elements of the state vectors processed by a single
+ * thread in the functions below.
+ *
+ * Each element of the results is computed by the same operations whatever
+ * the number of threads (see Parallel::setNumThreads()), so that the results
+ * do not depend on it.
+ */
+constexpr size_t StateChunkSize = size_t(1) << 15;
+
+/**
+ * Copies the strided kernel values \c strided into the contiguous vector \c out.
+ *
+ * The index map of the strided view is evaluated once per element, so that the
+ * state update kernels below can read their factors sequentially.
+ */
+template <class VEC>
+void gatherStrided(const VEC& strided, RealVector& out)
+{
+   out.resize(strided.size(), false);
+   Parallel::forEachRange(out.size(), StateChunkSize, [&](size_t begin, size_t end) {
+         for (size_t i = begin; i < end; i++)
+            out[i] = strided(i);
+         });
+}
+
+/**
+ * Updates the orders of a coordinate-uniform state in a single cache-blocked pass.
+ *
+ * Computes, by decreasing order \f$\ell\f$ from <CODE>state.size() - 1</CODE>
+ * down to 1,
+ * \f[
+ *    \boldsymbol p_\ell \gets \boldsymbol p_\ell +
+ *    (c \, \boldsymbol\omega) \odot \boldsymbol p_{\ell-1},
+ * \f]
+ * where \f$\boldsymbol p_\ell\f$ is the \f$\ell\f$-th element of \c state,
+ * \f$\boldsymbol\omega\f$ is \c factors and \f$c\f$ is \c scale, all
+ * vectors of size \c size.
+ * The result is the same, bit for bit, as the equivalent ublas expressions
+ * evaluated order by order.
+ */
+void updateStateOrders(const std::vector<Real*>& state, const Real* factors, Real scale, size_t size);
+
+/**
+ * Same as above, for a container of ublas vectors (see StateVector).
+ */
+template <class VEC>
+void updateStateOrders(std::vector<VEC>& state, const RealVector& factors, Real scale)
+{
+   std::vector<Real*> orders;
+   orders.reserve(state.size());
+   for (auto& vec : state)
+      orders.push_back(vec.data().begin());
+   updateStateOrders(orders, factors.data().begin(), scale, factors.size());
+}
+
+/**
+ * Updates a state for product weights: computes
+ * \f$\boldsymbol p \gets (\boldsymbol 1 + \gamma \boldsymbol\omega) \odot \boldsymbol p\f$,
+ * where \f$\boldsymbol p\f$ is \c state, \f$\boldsymbol\omega\f$ is \c factors
+ * and \f$\gamma\f$ is \c weight, both vectors of size \c size.
+ */
+void updateProductState(Real* state, const Real* factors, Real weight, size_t size);
+
+/**
+ * Same as above, for ublas vectors (see StateVector).
+ */
+template <class VEC>
+void updateProductState(VEC& state, const RealVector& factors, Real weight)
+{ updateProductState(state.data().begin(), factors.data().begin(), weight, state.size()); }
+
+/**
+ * Computes \f$c \sum_\ell \Gamma_\ell \boldsymbol p_\ell\f$ in a single
+ * cache-blocked pass, where \f$\boldsymbol p_\ell\f$ is the \f$\ell\f$-th element of \c state,
+ * \f$\Gamma_\ell\f$ the \f$\ell\f$-th element of \c weights and \f$c\f$ is \c scale, and
+ * stores it in \c out, all vectors of size \c size.
+ * Orders with a zero weight are skipped. The terms are added by increasing order.
+ */
+void weightedStateSum(const std::vector<const Real*>& state, const std::vector<Real>& weights, Real scale, Real* out, size_t size);
+
+/**
+ * Same as above, for a container of ublas vectors (see StateVector).
+ */
+template <class VEC>
+void weightedStateSum(const std::vector<VEC>& state, const std::vector<Real>& weights, Real scale, RealVector& out)
+{
+   std::vector<const Real*> terms;
+   terms.reserve(state.size());
+   for (const auto& vec : state)
+      terms.push_back(vec.data().begin());
+   weightedStateSum(terms, weights, scale, out.data().begin(), out.size());
+}
+
+/**
+ * Returns the sum of the weighted states of the states in \c states, added in
+ * the order of the list, which must not be empty.
+ *
+ * The weighted states are accumulated one at a time, so that at most two of
+ * them are held in memory.
+ */
+template <class STATE_LIST>
+RealVector sumWeightedStates(const STATE_LIST& states)
+{
+   auto it = states.begin();
+   RealVector out = (*it)->weightedState();
+   for (++it; it != states.end(); ++it) {
+      const RealVector term = (*it)->weightedState();
+      Parallel::forEachRange(out.size(), StateChunkSize, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++)
+               out[i] += term[i];
+            });
+   }
+   return out;
+}
+
+}}
+
+#endif
@@ -0,0 +1,118 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * Execution of independent tasks on several threads.
+ */
+
+#ifndef LATBUILDER__PARALLEL_H
+#define LATBUILDER__PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace LatBuilder {
+
+/**
+ * Execution of independent tasks on several threads, used to compute the
+ * FFT's of the fast CBC algorithm and to update the coordinate-uniform states.
+ *
+ * The tasks are taken in increasing order of index by the threads, so that the
+ * tasks should be sorted by decreasing cost.  Since each task is executed
+ * exactly once, on its own data, the results do not depend on the number of
+ * threads.
+ */
+class Parallel {
+public:
+   /**
+    * Sets the maximal number of threads used to execute the tasks.
+    * @param numThreads Maximal number of threads (default: 1). If \c 0, all the hardware threads are used.
+    */
+   static void setNumThreads(unsigned int numThreads);
+
+   /**
+    * Returns the maximal number of threads used to execute the tasks.
+    */
+   static unsigned int numThreads();
+
+   /**
+    * Calls <CODE>func(i)</CODE> for <CODE>i = 0, ..., numTasks - 1</CODE>,
+    * concurrently on at most numThreads() threads, and returns when all the
+    * calls have returned.  If a call throws an exception, the remaining tasks
+    * are skipped and the first exception is rethrown.
+    */
+   template <class FUNC>
+   static void forEach(size_t numTasks, FUNC&& func)
+   {
+      std::atomic<size_t> nextTask(0);
+      std::exception_ptr error;
+      std::mutex errorMutex;
+
+      auto worker = [&]()
+      {
+         size_t task;
+         while ((task = nextTask.fetch_add(1)) < numTasks) {
+            try {
+               func(task);
+            }
+            catch (...) {
+               std::lock_guard<std::mutex> lock(errorMutex);
+               if (!error)
+                  error = std::current_exception();
+               nextTask.store(numTasks);
+            }
+         }
+      };
+
+      const size_t threads = std::min<size_t>(numThreads(), numTasks);
+      std::vector<std::thread> workers;
+      for (size_t t = 1; t < threads; t++)
+         workers.emplace_back(worker);
+      worker();
+      for (auto& thread : workers)
+         thread.join();
+
+      if (error)
+         std::rethrow_exception(error);
+   }
+
+   /**
+    * Calls <CODE>func(begin, end)</CODE> on the consecutive ranges of \c grain
+    * indices (the last one may be shorter) that cover <CODE>0, ..., size - 1</CODE>,
+    * concurrently as with forEach().
+    * The ranges do not depend on the number of threads, so that elementwise
+    * computations give the same results with any number of threads.
+    */
+   template <class FUNC>
+   static void forEachRange(size_t size, size_t grain, FUNC&& func)
+   {
+      const size_t numRanges = (size + grain - 1) / grain;
+      forEach(numRanges, [&](size_t range) {
+            const size_t begin = range * grain;
+            func(begin, std::min(size, begin + grain));
+            });
+   }
+};
+
+}
+
+#endif
@@ -19,6 +19,7 @@
 
 #include <boost/iterator/iterator_facade.hpp>
 
+#include <iterator>
 #include <vector>
 
 namespace LatBuilder {
@@ -195,6 +196,35 @@ public:
          m_seq(&seq), m_at_end(true)
       { }
 
+      /**
+       * Constructs an iterator pointing to the element of rank \c rank in
+       * the Cartesian product of the unidimensional sequences, the last
+       * sequence varying the fastest.
+       * The iterator points past the end of the sequence if \c rank is not
+       * smaller than the size of the sequence.
+       */
+      const_iterator(const SeqCombiner& seq, size_t rank):
+         m_seq(&seq), m_at_end(m_seq->seqs().size() == 0 or rank >= m_seq->size())
+      {
+         if (m_at_end)
+            return;
+
+         const auto& seqs = m_seq->seqs();
+         // number of elements spanned by one step of each component
+         std::vector<size_t> strides(seqs.size(), 1);
+         for (size_t j = seqs.size() - 1; j > 0; --j)
+            strides[j - 1] = strides[j] * seqs[j].size();
+
+         m_value.reserve(seqs.size());
+         m_its.reserve(seqs.size());
+         for (size_t j = 0; j < seqs.size(); ++j) {
+            auto it = seqs[j].begin();
+            std::advance(it, (rank / strides[j]) % seqs[j].size());
+            m_its.push_back(it);
+            m_value.push_back(*it);
+         }
+      }
+
       /**
        * Returns a reference to the sequence.
        */
@@ -256,6 +286,17 @@ public:
    const_iterator end() const
    { return const_iterator(*this, typename const_iterator::end_tag{}); }
 
+   /**
+    * Returns an iterator pointing to the element of rank \c rank in the
+    * sequence. Only meaningful with the CartesianProduct policy, in which
+    * case incrementing the iterator yields the elements of ranks
+    * <tt>rank + 1</tt>, <tt>rank + 2</tt>, ...
+    * Random access to the unidimensional sequences is not required: their
+    * iterators are advanced step by step.
+    */
+   const_iterator at(size_t rank) const
+   { return const_iterator(*this, rank); }
+
    size_t size() const
    {
          return m_size;
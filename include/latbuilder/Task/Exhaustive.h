@@ -69,7 +69,10 @@ struct LatSeqBasedSearchTraits<ExhaustiveTag<LR, ET, COMPRESS, PLO, FIGURE>> {
    { return "Task: LatBuilder Search for " + to_string(LR)  + " lattices\nExploration method: Exhaustive";}
 
    void init(LatBuilder::Task::Exhaustive<LR, ET, COMPRESS, PLO, FIGURE>& search) const
-   { connectCBCProgress(search.cbc(), search.minObserver(), search.filters().empty()); }
+   {
+      connectCBCProgress(search.cbc(), search.minObserver(), search.filters().empty());
+      connectPrefixProgress(search.latSeqOverCBC(), search.minObserver(), search.filters().empty());
+   }
 };
 
 TASK_FOR_ALL(TASK_EXTERN_TEMPLATE, LatSeqBasedSearch, Exhaustive);
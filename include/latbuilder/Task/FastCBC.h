@@ -23,6 +23,7 @@
 #include "latbuilder/CoordUniformFigureOfMerit.h"
 #include "latbuilder/MeritSeq/CoordUniformInnerProdFast.h"
 #include "latbuilder/GenSeq/CyclicGroup.h"
+#include "latbuilder/GenSeq/GeneratingValues.h"
 #include "latbuilder/GenSeq/VectorCreator.h"
 #include "latbuilder/Util.h"
 
@@ -31,6 +32,33 @@ namespace LatBuilder { namespace Task {
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE>
 struct FastCBCTag {};
 
+namespace detail {
+   /**
+    * Sequence of generator values explored by the fast CBC algorithm: the
+    * cyclic group of units for prime-power and irreducible moduli, and all
+    * integers coprime with the modulus for (simple) ordinary lattice rules,
+    * which support an arbitrary number of points.
+    */
+   template <LatticeType LR, EmbeddingType ET, Compress COMPRESS>
+   struct FastCBCGenSeq {
+      typedef GenSeq::CyclicGroup<LR, COMPRESS> Type;
+
+      /// Returns the sequence for the first coordinate, reduced to the generator value 1.
+      static Type first(const SizeParam<LR, ET>&)
+      { return GenSeq::Creator<Type>::create(SizeParam<LR, ET>(LatticeTraits<LR>::TrivialModulus)); }
+   };
+
+   template <Compress COMPRESS>
+   struct FastCBCGenSeq<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, COMPRESS> {
+      typedef GenSeq::GeneratingValues<LatticeType::ORDINARY, COMPRESS> Type;
+
+      /// Returns the sequence for the first coordinate, reduced to the generator value 1,
+      /// which is the first integer coprime with the modulus.
+      static Type first(const SizeParam<LatticeType::ORDINARY, EmbeddingType::UNILEVEL>& sizeParam)
+      { return Type(sizeParam.modulus(), Traversal::Forward(0, 1)); }
+   };
+}
+
 
 /// Fast CBC exploration.
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO, class FIGURE> using FastCBC =
@@ -54,12 +82,12 @@ struct CBCBasedSearchTraits<FastCBCTag<LR, ET, COMPRESS, PLO, CoordUniformFigure
    typedef typename LatBuilder::Storage<LR, ET, COMPRESS, PLO>::SizeParam SizeParam;
    typedef MeritSeq::CoordUniformCBC<LR, ET, COMPRESS, PLO, KERNEL, MeritSeq::CoordUniformInnerProdFast> CBC;
    typedef typename CBC::FigureOfMerit FigureOfMerit;
-   typedef GenSeq::CyclicGroup<LR, COMPRESS> GenSeqType;
+   typedef typename detail::FastCBCGenSeq<LR, ET, COMPRESS>::Type GenSeqType;
 
    std::vector<GenSeqType> genSeqs(const SizeParam& sizeParam, Dimension dimension) const
    {
       auto vec = GenSeq::VectorCreator<GenSeqType>::create(sizeParam, dimension);
-      vec[0] = GenSeq::Creator<GenSeqType>::create(SizeParam(LatticeTraits<LR>::TrivialModulus));
+      vec[0] = detail::FastCBCGenSeq<LR, ET, COMPRESS>::first(sizeParam);
       return vec;
    }
 
@@ -78,14 +106,14 @@ struct CBCBasedSearchTraits<FastCBCTag<LR, ET, COMPRESS, PLO, FIGURE>> {
    typedef FIGURE FigureOfMerit;
    typedef typename LatBuilder::Storage<LR, ET, COMPRESS, PLO>::SizeParam SizeParam;
    typedef typename CBCSelector<LR, ET, COMPRESS, PLO, FIGURE>::CBC CBC;
-   typedef GenSeq::CyclicGroup<LR, COMPRESS> GenSeqType;
+   typedef typename detail::FastCBCGenSeq<LR, ET, COMPRESS>::Type GenSeqType;
 
    virtual ~CBCBasedSearchTraits() {}
 
    std::vector<GenSeqType> genSeqs(const SizeParam& sizeParam, Dimension dimension) const
    {
       auto vec = GenSeq::VectorCreator<GenSeqType>::create(sizeParam, dimension);
-      vec[0] = GenSeq::Creator<GenSeqType>::create(SizeParam(LatticeTraits<LR>::TrivialModulus));
+      vec[0] = detail::FastCBCGenSeq<LR, ET, COMPRESS>::first(sizeParam);
       return vec;
    }
 
@@ -31,6 +31,7 @@
 // for the connect functions
 #include "latbuilder/MeritSeq/CBC.h"
 #include "latbuilder/MeritSeq/CoordUniformCBC.h"
+#include "latbuilder/MeritSeq/LatSeqOverCBC.h"
 
 #include <boost/signals2.hpp>
 
@@ -443,6 +444,26 @@ void connectCBCProgress(const MeritSeq::CoordUniformCBC<LR, ET, COMPRESS, PLO, K
    // nothing to do with coordinate-uniform CBC
 }
 
+/**
+ * Connects MeritSeq::LatSeqOverCBC::onProgress() with the
+ * Search::MinObserver::progress() function and activates
+ * Search::MinObserver::setTruncateSum(), so that the generating vectors which
+ * start with components whose merit value is not smaller than the current
+ * minimum value are skipped.
+ */
+template <class CBC, class OBSERVER>
+void connectPrefixProgress(const MeritSeq::LatSeqOverCBC<CBC>& latSeqOverCBC, OBSERVER& obs, bool truncateSum) {
+   typedef typename CBC::MeritValue MeritValue;
+   typedef bool (OBSERVER::*ProgressCallback)(const MeritValue&) const;
+   ProgressCallback progress = &OBSERVER::progress;
+
+   // NOTE: this doesn't work for embedded lattices.
+   latSeqOverCBC.onProgress().connect(boost::bind(progress, &obs, boost::placeholders::_1));
+
+   // skip generating vectors only if no filters are applied downstream
+   obs.setTruncateSum(truncateSum);
+}
+
 }}
 
 #endif
@@ -30,11 +30,24 @@
 
 #include <stdexcept>
 #include <complex>
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
 #include <fftw3.h>
 
 
 /**
- * Wrapper for a subset of FFTW: FFT's for real functions in one dimension.
+ * Wrapper for a subset of FFTW: FFT's for real functions in one or several dimensions.
+ *
+ * The plans are created once for each transform shape, direction and alignment of the arrays, and cached for the
+ * lifetime of the program. They are created on scratch arrays and executed on the actual arrays with the new-array
+ * execute functions of FFTW, so that the transforms can be computed concurrently by several threads.
+ * Since the plans are reused, the planner can be asked to spend more time to find faster algorithms
+ * (see set_planner_flags()), and the results of the planner can be saved to a file of wisdom (see export_wisdom())
+ * for the next runs.
+ * If \c FFTWXX_USE_THREADS is defined (which requires linking with the threaded FFTW library), the plans of the
+ * large transforms can also use several threads (see set_num_threads()).
  */
 template <typename T>
 struct fftw
@@ -84,6 +97,9 @@ struct fftw
    /// Complex number.
    typedef std::complex<T> complex;
 
+   /// Shape of a multidimensional array, in row-major order.
+   typedef std::vector<int> shape_type;
+
 #ifdef FFTWXX_USE_BOOST_VECTOR
    typedef std::vector<real, allocator<real> > real_storage;
    typedef std::vector<complex, allocator<complex> > complex_storage;
@@ -101,6 +117,64 @@ struct fftw
    typedef std::vector<complex, allocator<complex> > complex_vector;
 #endif
 
+   /**
+    * Sets the flags passed to the FFTW planner for the plans which are not cached yet: \c FFTW_ESTIMATE (default),
+    * \c FFTW_MEASURE, \c FFTW_PATIENT or \c FFTW_EXHAUSTIVE. Plans of the rigorous kinds are slower to create
+    * but faster to execute; their creation is fast if the wisdom of a previous run was imported (see import_wisdom()).
+    */
+   static void set_planner_flags(unsigned flags)
+   {
+      auto& c = cache();
+      std::lock_guard<std::mutex> lock(c.mutex);
+      c.flags = flags;
+   }
+
+   /**
+    * Returns the flags passed to the FFTW planner.
+    */
+   static unsigned planner_flags()
+   {
+      auto& c = cache();
+      std::lock_guard<std::mutex> lock(c.mutex);
+      return c.flags;
+   }
+
+   /**
+    * Sets the number of threads used by the plans which are not cached yet, for the transforms of at least
+    * \c min_size real elements; the smaller transforms use a single thread.
+    * This has no effect unless \c FFTWXX_USE_THREADS is defined. The threaded plans may round differently
+    * from the single-threaded ones.
+    */
+   static void set_num_threads(int num_threads, size_t min_size)
+   {
+      auto& c = cache();
+      std::lock_guard<std::mutex> lock(c.mutex);
+      c.threads = num_threads < 1 ? 1 : num_threads;
+      c.threaded_min_size = min_size;
+   }
+
+   /**
+    * Imports FFTW wisdom from the file \c filename.
+    * Returns \c false if the file cannot be read or does not contain valid wisdom.
+    */
+   static bool import_wisdom(const std::string& filename)
+   {
+      auto& c = cache();
+      std::lock_guard<std::mutex> lock(c.mutex);
+      return c_api::import_wisdom_from_filename(filename.c_str()) != 0;
+   }
+
+   /**
+    * Exports the FFTW wisdom accumulated by the planner, including imported wisdom, to the file \c filename.
+    * Returns \c false if the file cannot be written.
+    */
+   static bool export_wisdom(const std::string& filename)
+   {
+      auto& c = cache();
+      std::lock_guard<std::mutex> lock(c.mutex);
+      return c_api::export_wisdom_to_filename(filename.c_str()) != 0;
+   }
+
    /**
     * Computes the real-to-complex Fourier transform of \c v into \c result.
     * The size of the transform is that of the real component.
@@ -113,13 +187,8 @@ struct fftw
       if (result.size() < fft_size(v))
          throw std::invalid_argument("fftw::fft(): result must have size v.size() / 2 + 1");
       // the transform is performed out-of-place, hence the const_cast is safe
-      typename c_api::plan p = c_api::plan_dft_r2c_1d(
-            static_cast<int>(v.size()),
-            const_cast<typename real_vector::value_type*>(&v[0]),
-            &result[0],
-            FFTW_ESTIMATE);
-      c_api::execute(p);
-      c_api::destroy_plan(p);
+      real* in = const_cast<typename real_vector::value_type*>(&v[0]);
+      c_api::execute_dft_r2c(plan_r2c(shape_type(1, static_cast<int>(v.size())), in, &result[0]), in, &result[0]);
       return result;
    }
 
@@ -162,13 +231,8 @@ struct fftw
       if (v.size() < fft_size(result))
          throw std::invalid_argument("fftw::ifft(): v must have size result.size() / 2 + 1");
       // the transform is performed out-of-place, hence the const_cast is safe
-      typename c_api::plan p = c_api::plan_dft_c2r_1d(
-            static_cast<int>(result.size()),
-            const_cast<typename complex_vector::value_type*>(&v[0]),
-            &result[0],
-            FFTW_ESTIMATE);
-      c_api::execute(p);
-      c_api::destroy_plan(p);
+      complex* in = const_cast<typename complex_vector::value_type*>(&v[0]);
+      c_api::execute_dft_c2r(plan_c2r(shape_type(1, static_cast<int>(result.size())), in, &result[0]), in, &result[0]);
       if (normalize) {
          real norm = static_cast<real>(1.0 / result.size());
          for (typename real_vector::iterator it = result.begin(); it != result.end(); ++it)
@@ -198,6 +262,174 @@ struct fftw
       ifft(v, fv, normalize);
       return fv;
    }
+
+   /**
+    * Computes the real-to-complex Fourier transform of the multidimensional
+    * array \c v, stored in row-major order, into \c result.
+    * The expected size of result is given by fft_size(const shape_type&): as
+    * in one dimension, only half of the last dimension (plus one) is stored.
+    */
+   static complex_vector& fft(const shape_type& shape, const real_vector& v, complex_vector& result)
+   {
+      if (v.size() < real_size(shape) || result.size() < fft_size(shape))
+         throw std::invalid_argument("fftw::fft(): invalid array sizes for the shape of the transform");
+      // the transform is performed out-of-place, hence the const_cast is safe
+      real* in = const_cast<typename real_vector::value_type*>(&v[0]);
+      c_api::execute_dft_r2c(plan_r2c(shape, in, &result[0]), in, &result[0]);
+      return result;
+   }
+
+   /**
+    * Computes the real-to-complex Fourier transform of the multidimensional
+    * array \c v, stored in row-major order.
+    * \sa fft(const shape_type&, const real_vector&, complex_vector&)
+    */
+   static complex_vector fft(const shape_type& shape, const real_vector& v)
+   {
+      complex_vector fv(fft_size(shape));
+      fft(shape, v, fv);
+      return fv;
+   }
+
+   /**
+    * Computes the complex-to-real Fourier transform of the multidimensional
+    * array \c v into \c result, stored in row-major order.
+    * \sa ifft(const complex_vector&, real_vector&, bool)
+    */
+   static real_vector& ifft(const shape_type& shape, const complex_vector& v, real_vector& result, bool normalize=true)
+   {
+      if (v.size() < fft_size(shape) || result.size() < real_size(shape))
+         throw std::invalid_argument("fftw::ifft(): invalid array sizes for the shape of the transform");
+      // the transform is performed out-of-place, hence the const_cast is safe
+      complex* in = const_cast<typename complex_vector::value_type*>(&v[0]);
+      c_api::execute_dft_c2r(plan_c2r(shape, in, &result[0]), in, &result[0]);
+      if (normalize) {
+         real norm = static_cast<real>(1.0 / real_size(shape));
+         for (typename real_vector::iterator it = result.begin(); it != result.end(); ++it)
+            *it *= norm;
+      }
+      return result;
+   }
+
+   /**
+    * Returns the number of elements of a real array of shape \c shape.
+    */
+   static size_t real_size(const shape_type& shape)
+   {
+      size_t size = 1;
+      for (int n : shape)
+         size *= n;
+      return size;
+   }
+
+   /**
+    * Returns the output size for the real-to-complex Fourier transform of an
+    * array of shape \c shape.
+    */
+   static size_t fft_size(const shape_type& shape)
+   { return shape.empty() ? 1 : real_size(shape) / shape.back() * (shape.back() / 2 + 1); }
+
+private:
+   /// Key of the cached plans: shape, direction (0 for real-to-complex, 1 for complex-to-real),
+   /// alignments of the input and output arrays, planner flags and number of threads.
+   typedef std::tuple<shape_type, int, int, int, unsigned, int> plan_key;
+
+   /// Cache of the plans, shared by all the threads.
+   struct plan_cache
+   {
+      std::mutex mutex; // protects the cache and the FFTW planner, which is not thread-safe
+      unsigned flags = FFTW_ESTIMATE;
+      int threads = 1;
+      size_t threaded_min_size = 0;
+      std::map<plan_key, typename c_api::plan> plans;
+
+      /// Returns the number of threads of the plans of shape \c shape; must be called with the mutex locked.
+      int threads_for(const shape_type& shape) const
+      {
+#ifdef FFTWXX_USE_THREADS
+         return real_size(shape) >= threaded_min_size ? threads : 1;
+#else
+         return 1;
+#endif
+      }
+
+      /// Prepares the planner for plans with \c n threads; must be called with the mutex locked.
+      void plan_with_threads(int n)
+      {
+#ifdef FFTWXX_USE_THREADS
+         static const bool initialized = c_api::init_threads() != 0;
+         if (!initialized)
+            throw std::runtime_error("fftw: cannot initialize threads");
+         c_api::plan_with_nthreads(n);
+#endif
+      }
+
+      ~plan_cache()
+      {
+         for (const auto& p : plans)
+            c_api::destroy_plan(p.second);
+      }
+   };
+
+   static plan_cache& cache()
+   {
+      static plan_cache instance;
+      return instance;
+   }
+
+   /// Array allocated by FFTW, offset so that its alignment is that of the arrays of a plan.
+   struct scratch_array
+   {
+      void* base;
+      void* data;
+
+      scratch_array(size_t bytes, int alignment):
+         base(c_api::malloc(bytes + alignment)),
+         data(static_cast<char*>(base) + alignment)
+      {}
+
+      ~scratch_array() { c_api::free(base); }
+   };
+
+   /// Returns the cached plan of shape \c shape for the real-to-complex transform of \c in into \c out, creating it if needed.
+   static auto plan_r2c(const shape_type& shape, real* in, complex* out)
+   {
+      auto& c = cache();
+      std::lock_guard<std::mutex> lock(c.mutex);
+      const plan_key key(shape, 0, c_api::alignment_of(in), c_api::alignment_of(reinterpret_cast<real*>(out)), c.flags, c.threads_for(shape));
+      auto it = c.plans.find(key);
+      if (it == c.plans.end()) {
+         // the planner may overwrite the arrays, hence the scratch arrays
+         scratch_array sin(real_size(shape) * sizeof(real), std::get<2>(key));
+         scratch_array sout(fft_size(shape) * sizeof(complex), std::get<3>(key));
+         c.plan_with_threads(std::get<5>(key));
+         auto p = c_api::plan_dft_r2c(static_cast<int>(shape.size()), shape.data(), static_cast<real*>(sin.data), static_cast<complex*>(sout.data), c.flags);
+         if (!p)
+            throw std::runtime_error("fftw::fft(): cannot create plan");
+         it = c.plans.emplace(key, p).first;
+      }
+      return it->second;
+   }
+
+   /// Returns the cached plan of shape \c shape for the complex-to-real transform of \c in into \c out, creating it if needed.
+   static auto plan_c2r(const shape_type& shape, complex* in, real* out)
+   {
+      auto& c = cache();
+      std::lock_guard<std::mutex> lock(c.mutex);
+      const plan_key key(shape, 1, c_api::alignment_of(reinterpret_cast<real*>(in)), c_api::alignment_of(out), c.flags, c.threads_for(shape));
+      auto it = c.plans.find(key);
+      if (it == c.plans.end()) {
+         // the planner may overwrite the arrays, hence the scratch arrays
+         scratch_array sin(fft_size(shape) * sizeof(complex), std::get<2>(key));
+         scratch_array sout(real_size(shape) * sizeof(real), std::get<3>(key));
+         c.plan_with_threads(std::get<5>(key));
+         auto p = c_api::plan_dft_c2r(static_cast<int>(shape.size()), shape.data(), static_cast<complex*>(sin.data), static_cast<real*>(sout.data), c.flags);
+         if (!p)
+            throw std::runtime_error("fftw::ifft(): cannot create plan");
+         it = c.plans.emplace(key, p).first;
+      }
+      return it->second;
+   }
 };
 
 /**
@@ -224,11 +456,43 @@ struct fftw<float>::c_api
    static plan plan_dft_c2r_1d(int n, complex *in, real *out, unsigned flags)
    { return fftwf_plan_dft_c2r_1d(n, reinterpret_cast<fftwf_complex*>(in), out, flags); }
 
+   // this works as long as the data in std::complex is [real, imag]
+   static plan plan_dft_r2c(int rank, const int *n, real *in, complex *out, unsigned flags)
+   { return fftwf_plan_dft_r2c(rank, n, in, reinterpret_cast<fftwf_complex*>(out), flags); }
+
+   // this works as long as the data in std::complex is [real, imag]
+   static plan plan_dft_c2r(int rank, const int *n, complex *in, real *out, unsigned flags)
+   { return fftwf_plan_dft_c2r(rank, n, reinterpret_cast<fftwf_complex*>(in), out, flags); }
+
    static void destroy_plan(plan p)
    { fftwf_destroy_plan(p); }
 
    static void execute(const plan p)
    { return fftwf_execute(p); }
+
+   // new-array execute functions, which are thread-safe
+   static void execute_dft_r2c(const plan p, real *in, complex *out)
+   { fftwf_execute_dft_r2c(p, in, reinterpret_cast<fftwf_complex*>(out)); }
+
+   static void execute_dft_c2r(const plan p, complex *in, real *out)
+   { fftwf_execute_dft_c2r(p, reinterpret_cast<fftwf_complex*>(in), out); }
+
+   static int alignment_of(real *p)
+   { return fftwf_alignment_of(p); }
+
+   static int import_wisdom_from_filename(const char *filename)
+   { return fftwf_import_wisdom_from_filename(filename); }
+
+   static int export_wisdom_to_filename(const char *filename)
+   { return fftwf_export_wisdom_to_filename(filename); }
+
+#ifdef FFTWXX_USE_THREADS
+   static int init_threads()
+   { return fftwf_init_threads(); }
+
+   static void plan_with_nthreads(int n)
+   { fftwf_plan_with_nthreads(n); }
+#endif
 };
 
 /**
@@ -255,11 +519,43 @@ struct fftw<double>::c_api
    static plan plan_dft_c2r_1d(int n, complex *in, real *out, unsigned flags)
    { return fftw_plan_dft_c2r_1d(n, reinterpret_cast<fftw_complex*>(in), out, flags); }
 
+   // this works as long as the data in std::complex is [real, imag]
+   static plan plan_dft_r2c(int rank, const int *n, real *in, complex *out, unsigned flags)
+   { return fftw_plan_dft_r2c(rank, n, in, reinterpret_cast<fftw_complex*>(out), flags); }
+
+   // this works as long as the data in std::complex is [real, imag]
+   static plan plan_dft_c2r(int rank, const int *n, complex *in, real *out, unsigned flags)
+   { return fftw_plan_dft_c2r(rank, n, reinterpret_cast<fftw_complex*>(in), out, flags); }
+
    static void destroy_plan(plan p)
    { fftw_destroy_plan(p); }
 
    static void execute(const plan p)
    { return fftw_execute(p); }
+
+   // new-array execute functions, which are thread-safe
+   static void execute_dft_r2c(const plan p, real *in, complex *out)
+   { fftw_execute_dft_r2c(p, in, reinterpret_cast<fftw_complex*>(out)); }
+
+   static void execute_dft_c2r(const plan p, complex *in, real *out)
+   { fftw_execute_dft_c2r(p, reinterpret_cast<fftw_complex*>(in), out); }
+
+   static int alignment_of(real *p)
+   { return fftw_alignment_of(p); }
+
+   static int import_wisdom_from_filename(const char *filename)
+   { return fftw_import_wisdom_from_filename(filename); }
+
+   static int export_wisdom_to_filename(const char *filename)
+   { return fftw_export_wisdom_to_filename(filename); }
+
+#ifdef FFTWXX_USE_THREADS
+   static int init_threads()
+   { return fftw_init_threads(); }
+
+   static void plan_with_nthreads(int n)
+   { fftw_plan_with_nthreads(n); }
+#endif
 };
 
 
@@ -71,8 +71,11 @@
 
 #include "netbuilder/Types.h"
 #include "netbuilder/GeneratingMatrix.h"
+#include "netbuilder/ProjectionView.h"
 #include "netbuilder/NetConstructionTraits.h"
 
+#include "latticetester/Coordinates.h"
+
 #include <memory>
 #include <sstream>
 #include <stdexcept>
@@ -143,6 +146,22 @@ class AbstractDigitalNet
             return *m_generatingMatrices[coord];
         }
 
+        /** 
+         * Returns pointers to the generating matrices corresponding to the coordinates of \c projection, in the order of the projection.
+         * The matrices are not copied. The result is meant to be used as a ProjectionView.
+         * @param projection A projection of the net.
+         */
+        std::vector<const GeneratingMatrix*> generatingMatrices(const LatticeTester::Coordinates& projection) const 
+        {
+            std::vector<const GeneratingMatrix*> res;
+            res.reserve(projection.size());
+            for (auto coord : projection)
+            {
+                res.push_back(m_generatingMatrices[coord].get());
+            }
+            return res;
+        }
+
         /**
          * Formats the net for output.
          * @param outputFormat Format of output.
@@ -29,6 +29,7 @@
 #include "latbuilder/ClonePtr.h"
 #include "latbuilder/MeritSeq/CoordUniformStateCreator.h"
 #include "latbuilder/MeritSeq/CoordUniformInnerProd.h"
+#include "latbuilder/MeritSeq/StateKernels.h"
 
 namespace NetBuilder{ namespace FigureOfMerit { 
 
@@ -166,8 +167,9 @@ namespace NetBuilder{ namespace FigureOfMerit {
                             m_sizeParam(SizeParam(1)),
                             m_storage(m_sizeParam),
                             m_innerProd(m_storage, m_figure->kernel()),
-                            m_memStates(LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights())),
-                            m_tmpStates(LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights()))
+                            m_states(LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights())),
+                            m_weightedStateValid(false),
+                            m_hasBestMatrix(false)
                         {};
 
 
@@ -176,7 +178,7 @@ namespace NetBuilder{ namespace FigureOfMerit {
                          */
                         const CoordUniformStateList<LatBuilder::LatticeType::DIGITAL, KERNEL::suggestedCompression()>& states() const
                         { 
-                            return m_memStates; 
+                            return m_states; 
                         }
 
                         /**
@@ -184,13 +186,9 @@ namespace NetBuilder{ namespace FigureOfMerit {
                          */
                         RealVector weightedState() const
                         {
-                            auto it = states().begin();
-                            if (it == states().end())
+                            if (states().empty())
                             throw std::runtime_error("CoordUniformCBC: empty list of states");
-                            auto out = (*it)->weightedState();
-                            while (++it != states().end())
-                            out += (*it)->weightedState();
-                            return out;
+                            return LatBuilder::MeritSeq::sumWeightedStates(states());
                         }
 
                         /**     
@@ -198,8 +196,9 @@ namespace NetBuilder{ namespace FigureOfMerit {
                          */ 
                         virtual void reset() override
                         {
-                            m_memStates = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
-                            m_tmpStates = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
+                            m_states = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
+                            m_weightedStateValid = false;
+                            m_hasBestMatrix = false;
                         }
 
                         /** 
@@ -235,9 +234,15 @@ namespace NetBuilder{ namespace FigureOfMerit {
 
                             MeritValue acc = initialValue; // create the accumulator from the initial value
 
+                            if (!m_weightedStateValid) // the states only change between two coordinates
+                            {
+                                m_weightedState = weightedState();
+                                m_weightedStateValid = true;
+                            }
+
                             lastMatrix = net.generatingMatrix(dimension);
                             std::vector<GeneratingMatrix> genSeq {lastMatrix};
-                            auto prodSeq = m_innerProd.prodSeq(genSeq, weightedState());
+                            auto prodSeq = m_innerProd.prodSeq(genSeq, m_weightedState);
                             auto merit = *(prodSeq.begin());
                             m_sizeParam.normalize(merit);
                             acc += combine(merit);
@@ -257,7 +262,15 @@ namespace NetBuilder{ namespace FigureOfMerit {
                          */ 
                         virtual void prepareForNextDimension() override
                         {
-                            m_memStates = m_tmpStates;
+                            if (m_hasBestMatrix) // append the coordinate of the best net to the states
+                            {
+                                for (auto& state : m_states)
+                                {
+                                    state->update(m_innerProd.kernelValues(), m_bestMatrix);
+                                }
+                                m_hasBestMatrix = false;
+                                m_weightedStateValid = false;
+                            }
                         } 
 
                         /**
@@ -265,11 +278,8 @@ namespace NetBuilder{ namespace FigureOfMerit {
                          */
                         virtual void lastNetWasBest() override
                         {
-                            m_tmpStates = m_memStates;
-                            for (auto& state : m_tmpStates)
-                            {
-                                state->update(m_innerProd.kernelValues(), lastMatrix);
-                            }
+                            m_bestMatrix = lastMatrix; // the states are updated in prepareForNextDimension()
+                            m_hasBestMatrix = true;
                         }
 
                         void updateSizeParam(unsigned int m)
@@ -280,8 +290,9 @@ namespace NetBuilder{ namespace FigureOfMerit {
                                 m_sizeParam = SizeParam(1 << m);
                                 m_storage = Storage(m_sizeParam);
                                 m_innerProd = InnerProd(m_storage, m_figure->kernel());
-                                m_memStates = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
-                                m_tmpStates = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
+                                m_states = LatBuilder::MeritSeq::CoordUniformStateCreator::create(m_innerProd.internalStorage(), m_figure->weights());
+                                m_weightedStateValid = false;
+                                m_hasBestMatrix = false;
                             }
                         }
 
@@ -307,11 +318,13 @@ namespace NetBuilder{ namespace FigureOfMerit {
                         Storage m_storage; // storage for the kernel values
 
                         InnerProd m_innerProd; // used to compute inner products 
-                        StateList m_memStates; // states for the best net for the previous dimension
-                        StateList m_tmpStates; // states for the best net so far for the current dimension
-
+                        StateList m_states; // states for the best net for the previous dimension
+                        RealVector m_weightedState; // weighted state of m_states
+                        bool m_weightedStateValid; // whether m_weightedState is up to date
 
                         GeneratingMatrix lastMatrix; // last matrix of latets evaluated net for the current dimension
+                        GeneratingMatrix m_bestMatrix; // last matrix of the best net so far for the current dimension
+                        bool m_hasBestMatrix; // whether a best net was found for the current dimension
 
                 };
 
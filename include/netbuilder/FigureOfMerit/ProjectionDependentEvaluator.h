@@ -19,18 +19,38 @@
 
 #include "netbuilder/FigureOfMerit/WeightedFigureOfMerit.h"
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 namespace NetBuilder { namespace FigureOfMerit {
 
 /** 
  * Class to implement the evaluation of specific projection-dependent weighted figure of merit where
  * the merits of the subprojections of order one less are used to compute the merit of a bigger projection, for instance
  * the t-value of subprojections. 
+ * 
+ * The projections form a graph where each projection is linked to its subprojections of order one less (its mothers).
+ * The nodes of the graph are stored in a structure-of-arrays arena: each property of the nodes is stored in a
+ * contiguous array indexed by the node index, and the links between nodes are indices into these arrays.
+ * The nodes of a layer (the projections whose highest coordinate is the same) are stored contiguously in evaluation order,
+ * that is by increasing cardinal and decreasing weight, so that evaluating a layer is a linear scan of the arrays.
+ * The coordinates of each projection are computed once, when the node is created.
  * @tparam PROJDEP Template parameter representing the projection-dependent merit.
  */ 
 template <typename PROJDEP>
 class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator 
 {
+    private:
+
+        /// Type of merit value storage.
+        typedef typename PROJDEP::Merit MeritStorage;
 
+        /// Type of the combination of the merits of the subprojections.
+        typedef typename PROJDEP::SubProjCombination SubProjCombination; 
+
+        /// Type of the indices of the nodes.
+        typedef size_t NodeIndex;
 
     public:
 
@@ -42,27 +62,11 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
                     m_figure(figure),
                     m_numCoordinates(0),
                     m_maxNumCoordinates(0),
-                    m_maxCardinal(m_figure->projDepMerit().maxCardinal())
+                    m_maxCardinal(m_figure->projDepMerit().maxCardinal()),
+                    m_layerBegin(1, 0),
+                    m_mothersBegin(1, 0)
         {};
 
-        /** 
-         * Destructor. */
-        ~ProjectionDependentEvaluator()
-        {
-            for(Dimension dim = 0; dim < m_maxNumCoordinates; ++dim)
-            {
-                ProjectionNode* it = m_roots[dim];
-                ProjectionNode* nextIt = nullptr;
-                do
-                {
-                    nextIt = it->getNextNode();
-                    delete it;
-                    it = nextIt;
-                }
-                while(it != nullptr);
-            }
-        }
-
         /** 
          * Computes the figure of merit for the given \c net for the given \c dimension (partial computation), 
          * starting from the initial value \c initialValue.
@@ -77,21 +81,22 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
 
             auto acc = m_figure->accumulator(std::move(initialValue));
 
-            ProjectionNode* it = m_roots[dimension]; // iterator over the nodes
-            do
+            for (NodeIndex node = m_layerBegin[dimension]; node < m_layerBegin[dimension + 1]; ++node)
             {   
-                Real weight = it->getWeight();
+                Real weight = m_weight[node];
+
+                SubProjCombination& subProjCombination = m_subProjCombination[node];
                 
-                if (PROJDEP::size(it->getSubProjCombination()) < nLevels) // resize the subprojections combination if required
+                if (PROJDEP::size(subProjCombination) < nLevels) // resize the subprojections combination if required
                 {
-                    PROJDEP::resize(it->getSubProjCombination(), nLevels);
+                    PROJDEP::resize(subProjCombination, nLevels);
                 }
 
-                it->updateSubProjCombination(); // update the subprojection combination
+                updateSubProjCombination(node); // update the subprojection combination
 
-                LatticeTester::Coordinates proj = it->getProjectionRepresentation();
+                const LatticeTester::Coordinates& proj = m_projection[node];
 
-                auto grossMerit = m_figure->projDepMerit()(net, proj ,it->getSubProjCombination()); // compute the merit of the projection
+                auto grossMerit = m_figure->projDepMerit()(net, proj, subProjCombination); // compute the merit of the projection
 
                 Real merit = m_figure->projDepMerit().combine(grossMerit, net, proj); // combine in a single merit value
 
@@ -104,10 +109,8 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
                     break;
                 }
 
-                it->setMeritTmp(grossMerit); // update the merit of the node
-                it = it->getNextNode(); // skip to next node
+                m_meritTmp[node] = grossMerit; // update the merit of the node
             }
-            while(it != nullptr);
 
             return acc.value();
         }
@@ -150,241 +153,151 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
     private:
 
         /** 
-         * Represents a projection. The node is linked to the projections with order one less and with the following
-         * projection in the evaluation order. The node store some merit values.
+         * Returns the number of nodes in the arena.
          */ 
-        struct ProjectionNode
-        {
-            /// Type of merit value storage.
-            typedef typename PROJDEP::Merit MeritStorage;
-
-            /// Type of the combination of the merits of the subprojections.
-            typedef typename PROJDEP::SubProjCombination SubProjCombination; 
-
-            /** 
-             * Constructor.
-             * @param dimension Highest coordinate in all the projections of the layer.
-             * @param cardinal Cardinal of the projection.
-             * @param weight Importance of the projection in the figure of merit.
-             */ 
-            ProjectionNode(Dimension dimension, unsigned int cardinal, double weight):
-                m_weight(weight),
-                m_dimension(dimension),
-                m_cardinal(cardinal)
-            {};
-
-            /** 
-             * Returns the cardinal of the projection represented by the node.
-             */ 
-            unsigned int getCardinal() const { return m_cardinal; }
-
-            /** 
-             * Returns the maximum dimension, that is the highest coordinate in all the projections of the layer.
-             */ 
-            Dimension getMaxDimension() const { return m_dimension; }
-
-            /** Returns a pointer to the next projection to evaluate. May be null.
-             */ 
-            ProjectionNode* getNextNode() const { return m_nextNode; }
-
-            /** Set the next node of the current node.
-             * @param node is a pointer to the next node.
-             */ 
-            void setNextNode(ProjectionNode* node){ m_nextNode = node; }
-
-            /** 
-             * Returns a vector of pointers to the subprojections whose cardinal is one less than the
-             * projection's.
-             */ 
-            const std::vector<ProjectionNode*>& getMotherNodes() const { return m_mothersNodes; }
-
-            /** 
-             * Returns the projection represented by the node.
-             */ 
-            LatticeTester::Coordinates getProjectionRepresentation() const { 
-                LatticeTester::Coordinates res;
-                accumulateProjectionRepresentation(res);
-                return res;
-            }
+        NodeIndex numNodes() const { return m_weight.size(); }
 
-            /**
-             * Add a mother to the projection node.
-             * @param mother Pointer to the new mother.
-             */ 
-            void addMother(ProjectionNode* mother) { m_mothersNodes.push_back(mother); }
-
-            /** 
-             * Returns the weight of the projection represented by the node.
-             */ 
-            Real getWeight() const { return m_weight; }
-
-
-            /** Returns the stored merit of the projection represented by the node.
-             */ 
-            MeritStorage getMeritMem() const {return m_meritMem; }
-
-            /** Returns the temporary merit of the projection represented by the node.
-             */ 
-            MeritStorage getMeritTmp() const {return m_meritTmp; }
-
-
-            /** 
-             * Returns the maximum of the merits of the subprojections.
-             */ 
-            SubProjCombination& getSubProjCombination() { return m_subProjCombination; }
-
-            /** 
-             * Set the temporary merit of the node to be the given merit
-             * @param merit is the merit to assign to the node.
-             */ 
-            void setMeritTmp(MeritStorage merit) {m_meritTmp = merit; }
-
-            /** 
-             * Save the temporary merit in the m_meritMem field. 
-             */ 
-            void saveMerit() {m_meritMem = m_meritTmp; }
-
-            /** 
-             * Updates the combination of the merits of the subprojections (mothers). Note that for
-             * subprojections which also contain getMaxDimension(), the temporary merit is used
-             * whereas for other nodes, the stored merit is used. This allows component-by-component
-             * evaluation for several nets with a unique datastructure..
-             */ 
-            void updateSubProjCombination()
+        /** 
+         * Updates the combination of the merits of the subprojections (mothers) of \c node. Note that for
+         * subprojections which also contain the highest coordinate of the projection, the temporary merit is used
+         * whereas for other nodes, the stored merit is used. This allows component-by-component
+         * evaluation for several nets with a unique datastructure.
+         * @param node Index of the node.
+         */ 
+        void updateSubProjCombination(NodeIndex node)
+        {
+            if (m_cardinal[node] > 1)
             {
-                if (getCardinal() > 1)
+                SubProjCombination& subProjCombination = m_subProjCombination[node];
+                PROJDEP::setToZero(subProjCombination);
+                const Dimension dimension = m_maxDimension[node];
+                for (NodeIndex i = m_mothersBegin[node]; i < m_mothersBegin[node + 1]; ++i)
                 {
-                    PROJDEP::setToZero(m_subProjCombination);
-                    for (auto const* m : m_mothersNodes)
+                    const NodeIndex mother = m_mothers[i];
+                    if (m_maxDimension[mother] < dimension)
                     {
-                        if (m->getMaxDimension() < m_dimension)
-                        {
-                            PROJDEP::update(m->getMeritMem(), m_subProjCombination);
-                        }
-                        else{
-                            PROJDEP::update(m->getMeritTmp(), m_subProjCombination);
-                        } 
+                        PROJDEP::update(m_meritMem[mother], subProjCombination);
                     }
+                    else{
+                        PROJDEP::update(m_meritTmp[mother], subProjCombination);
+                    } 
                 }
             }
-
-            /** 
-             * Overloads operator < to compare projections. A projection is smaller (less important) than another one if they have the same cardinal and its weight is smaller
-             * of if it has a strictly bigger cardinal.
-             */ 
-            bool operator>(const ProjectionNode &b) const
-            {
-                return (getCardinal() == b.getCardinal()) ? 
-                            (getWeight() > b.getWeight()) : 
-                            (getCardinal() < b.getCardinal());
-            }
-
-            /** 
-             * Comparison between pointers to nodes by dereferencing. Used to sort by decreasing importance.
-             */ 
-            static bool compareNodePointers(const ProjectionNode* a, const ProjectionNode* b){
-                return (*a > * b);
-            }
-                    
-            /** 
-             * Overloading of the << operator to print projection nodes.
-             */
-            friend std::ostream& operator<<(std::ostream& os, const ProjectionNode& dt)
-            {
-                os << "projection: " << dt.getProjectionRepresentation() << " - weight: " << dt.getWeight();
-                return os;
-            }
-
-            double m_weight; // weight of the projection
-            Dimension m_dimension; // last dimension (highest coordinate in the projection)
-            unsigned int m_cardinal; // cardinal of the projection
-
-            ProjectionNode* m_nextNode = nullptr; // pointer to the next projection to evaluate
-            std::vector<ProjectionNode*> m_mothersNodes; // pointers to the subprojections whose cardinal is one less
-
-            SubProjCombination m_subProjCombination; // combination of the merits of the subprojections
-
-            MeritStorage m_meritMem; // stored merit
-            MeritStorage m_meritTmp; // temporay merit
-
-            void accumulateProjectionRepresentation(LatticeTester::Coordinates& projection) const
-            {
-                projection.insert(m_dimension);
-                if(m_cardinal>1)
-                {
-                    m_mothersNodes[0]->accumulateProjectionRepresentation(projection);
-                }
-            }
-        };
+        }
 
         /** 
          * Extends by one dimension the evaluator. This creates new nodes corresponding to the new projections to consider
          * while evaluating figures of merits.
+         * Each new projection other than the one-dimensional one is obtained by adding the new coordinate to a projection
+         * of a previous layer (its first mother), so that its other mothers are obtained by adding the new coordinate to the mothers 
+         * of this first mother.
          */ 
         void extend(){
             ++m_maxNumCoordinates; // increase maximal number of coordinates
-            std::vector<ProjectionNode*> newNodes; // to store new nodes
+            const Dimension newCoordinate = m_maxNumCoordinates - 1;
+            const NodeIndex numOldNodes = numNodes();
 
-            std::map<LatticeTester::Coordinates,ProjectionNode*> mapsToNodes; // map between new projections and new nodes
+            // candidate nodes, in creation order: the projection {newCoordinate}, then the extensions of the old nodes
+            std::vector<LatticeTester::Coordinates> projections; 
+            std::vector<Real> weights;
+            std::vector<NodeIndex> firstMothers; // old node extended by each candidate (unused for the first candidate)
+            std::vector<NodeIndex> candidateOfOldNode(numOldNodes, NoNode); // candidate extending each old node
 
-            // create projection {m_numCoordinates} 
             LatticeTester::Coordinates proj1DRep;
-            proj1DRep.insert(m_maxNumCoordinates-1);
-            double weight = m_figure->weights().getWeight(proj1DRep);
-            ProjectionNode* proj1D = new ProjectionNode(m_maxNumCoordinates-1, (unsigned int) proj1DRep.size(), weight);
+            proj1DRep.insert(newCoordinate);
+            weights.push_back(m_figure->weights().getWeight(proj1DRep));
+            projections.push_back(std::move(proj1DRep));
+            firstMothers.push_back(NoNode);
 
-            if(m_maxNumCoordinates==1){
-                m_roots.push_back(proj1D);
-                return;
+            for (NodeIndex node = 0; node < numOldNodes; ++node) // the old nodes are stored layer by layer in evaluation order
+            {
+                if (m_cardinal[node] <= m_maxCardinal-1)
+                {
+                    LatticeTester::Coordinates projectionRep = m_projection[node]; // consider the projection
+                    projectionRep.insert(newCoordinate);
+                    candidateOfOldNode[node] = projections.size();
+                    weights.push_back(m_figure->weights().getWeight(projectionRep));
+                    projections.push_back(std::move(projectionRep));
+                    firstMothers.push_back(node);
+                }
             }
 
-            newNodes.push_back(proj1D);
-
-            mapsToNodes.insert(std::pair<LatticeTester::Coordinates,ProjectionNode*>(std::move(proj1DRep),proj1D));
+            // sort the candidates by increasing cardinal and decreasing weights
+            std::vector<NodeIndex> order(projections.size());
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(order.begin(), order.end(), [&](NodeIndex a, NodeIndex b)
+            {
+                return (projections[a].size() == projections[b].size()) ? 
+                            (weights[a] > weights[b]) : 
+                            (projections[a].size() < projections[b].size());
+            });
 
+            std::vector<NodeIndex> nodeOfCandidate(order.size());
+            for (NodeIndex i = 0; i < order.size(); ++i)
+            {
+                nodeOfCandidate[order[i]] = numOldNodes + i;
+            }
 
-            for(unsigned int i = 0; i < m_maxNumCoordinates-1; ++i) // for each previous dimensions
+            // append the new nodes to the arena
+            std::vector<std::pair<Dimension, NodeIndex>> otherMothers; // mothers containing the new coordinate, with the coordinate they lack
+            for (NodeIndex candidate : order)
             {
-                ProjectionNode* it = m_roots[i];
-                do
-                {   if (it->getCardinal() <= m_maxCardinal-1)
+                const unsigned int cardinal = (unsigned int) projections[candidate].size();
+                m_weight.push_back(weights[candidate]);
+                m_maxDimension.push_back(newCoordinate);
+                m_cardinal.push_back(cardinal);
+                m_subProjCombination.emplace_back();
+                m_meritMem.emplace_back();
+                m_meritTmp.emplace_back();
+
+                const NodeIndex firstMother = firstMothers[candidate];
+                if (firstMother != NoNode)
+                {
+                    m_mothers.push_back(firstMother);
+
+                    otherMothers.clear();
+                    if (cardinal == 2)
                     {
-                        LatticeTester::Coordinates projectionRep = it->getProjectionRepresentation(); // consider the projection
-                        projectionRep.insert(m_maxNumCoordinates-1);
-                        double weight =  m_figure->weights().getWeight(projectionRep);
-                        ProjectionNode* newNode = new ProjectionNode(m_maxNumCoordinates-1, (unsigned int) projectionRep.size() , weight); // create the node
-                        newNode->addMother(it);
-                        mapsToNodes.insert(std::pair<LatticeTester::Coordinates,ProjectionNode*>(std::move(projectionRep),newNode));
-                        newNodes.push_back(newNode);
+                        otherMothers.emplace_back(*m_projection[firstMother].begin(), nodeOfCandidate[0]);
+                    }
+                    else
+                    {
+                        for (NodeIndex i = m_mothersBegin[firstMother]; i < m_mothersBegin[firstMother + 1]; ++i)
+                        {
+                            const NodeIndex mother = m_mothers[i];
+                            otherMothers.emplace_back(missingCoordinate(m_projection[firstMother], m_projection[mother]), nodeOfCandidate[candidateOfOldNode[mother]]);
+                        }
+                    }
+                    std::sort(otherMothers.begin(), otherMothers.end()); // by increasing missing coordinate
+                    for (const auto& mother : otherMothers)
+                    {
+                        m_mothers.push_back(mother.second);
                     }
-                    it = it->getNextNode();
                 }
-                while(it != nullptr);
+                m_mothersBegin.push_back(m_mothers.size());
             }
-
-            std::sort(newNodes.begin(), newNodes.end(), ProjectionNode::compareNodePointers); // sort the nodes by increasing cardinal and decreasing weights
-
-            m_roots.push_back(newNodes[0]); // add the root corresponding to the dimension
-
-            for(size_t i = 0; i < newNodes.size()-1; ++i)
+            for (NodeIndex candidate : order)
             {
-                newNodes[i]->setNextNode(newNodes[i+1]); // link the new nodes
+                m_projection.push_back(std::move(projections[candidate]));
             }
+            m_layerBegin.push_back(numNodes());
+        }
 
-            for (ProjectionNode* node : newNodes) // for each new nodes
-            {   
-                LatticeTester::Coordinates tmp = node->getProjectionRepresentation();
-                for(unsigned int i = 0; i < m_maxNumCoordinates-1; ++i) // link to mothers which contains m_numCoordinates
+        /** 
+         * Returns the coordinate of \c projection which is not in \c subProjection, the latter having one coordinate less.
+         */ 
+        static Dimension missingCoordinate(const LatticeTester::Coordinates& projection, const LatticeTester::Coordinates& subProjection)
+        {
+            auto it = projection.begin();
+            for (auto coord : subProjection)
+            {
+                if (*it != coord)
                 {
-                    if (tmp.find(i) != tmp.end())
-                    {
-                        tmp.erase(i);
-                        auto foo = mapsToNodes.find(tmp)->second;
-                        node->addMother(foo);
-                        tmp.insert(i);
-                    }
+                    break;
                 }
+                ++it;
             }
+            return *it;
         }
 
         /** Save the merits of all the nodes corresponding to the \c dimension.
@@ -392,13 +305,7 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
          */  
         void saveMerits(Dimension dimension)
         {
-            ProjectionNode* it = m_roots[dimension];
-            do
-            {
-                it->saveMerit();
-                it = it->getNextNode();
-            }
-            while(it != nullptr);
+            std::copy(m_meritTmp.begin() + m_layerBegin[dimension], m_meritTmp.begin() + m_layerBegin[dimension + 1], m_meritMem.begin() + m_layerBegin[dimension]);
         }
 
         /** 
@@ -412,14 +319,32 @@ class ProjectionDependentEvaluator : public CBCFigureOfMeritEvaluator
             }
         }
 
+        static constexpr NodeIndex NoNode = static_cast<NodeIndex>(-1); // marker for missing nodes
+
         WeightedFigureOfMerit<PROJDEP> * m_figure;
 
         Dimension m_numCoordinates; 
         Dimension m_maxNumCoordinates;
         unsigned int m_maxCardinal; 
-        std::vector<ProjectionNode*> m_roots; // pointer to the first node of each layer (one by dimension)
+
+        std::vector<NodeIndex> m_layerBegin; // index of the first node of each layer (one by dimension), followed by the number of nodes
+
+        std::vector<Real> m_weight; // weight of each projection
+        std::vector<Dimension> m_maxDimension; // highest coordinate of each projection
+        std::vector<unsigned int> m_cardinal; // cardinal of each projection
+        std::vector<LatticeTester::Coordinates> m_projection; // coordinates of each projection
+
+        std::vector<NodeIndex> m_mothersBegin; // index in m_mothers of the first mother of each node, followed by the number of links
+        std::vector<NodeIndex> m_mothers; // indices of the subprojections whose cardinal is one less, node by node
+
+        std::vector<SubProjCombination> m_subProjCombination; // combination of the merits of the subprojections of each node
+        std::vector<MeritStorage> m_meritMem; // stored merit of each node
+        std::vector<MeritStorage> m_meritTmp; // temporary merit of each node
 };
 
+template <typename PROJDEP>
+constexpr typename ProjectionDependentEvaluator<PROJDEP>::NodeIndex ProjectionDependentEvaluator<PROJDEP>::NoNode;
+
 }}
 
-#endif
\ No newline at end of file
+#endif
@@ -20,6 +20,7 @@
 #include "netbuilder/FigureOfMerit/WeightedFigureOfMerit.h"
 #include "netbuilder/Helpers/CBCCoordinateSet.h"
 #include "netbuilder/Helpers/RankComputer.h"
+#include "netbuilder/ProjectionView.h"
 #include "netbuilder/FigureOfMerit/LevelCombiner.h"
 
 namespace NetBuilder { namespace FigureOfMerit {
@@ -77,8 +78,18 @@ class ResolutionGapProjMerit<EmbeddingType::UNILEVEL>
          */ 
         Real operator()(const AbstractDigitalNet& net , const LatticeTester::Coordinates& projection) 
         {
-            Dimension dimension = projection.size();
-            unsigned int numCols = net.numColumns();
+            const std::vector<const GeneratingMatrix*> matrices = net.generatingMatrices(projection);
+            return (*this)(ProjectionView(matrices));
+        }
+
+        /** 
+         * Computes the projection-dependent merit of the projection whose generating matrices are \c matrices.
+         * @param matrices Generating matrices of the projection.
+         */ 
+        Real operator()(ProjectionView matrices) 
+        {
+            Dimension dimension = matrices.size();
+            unsigned int numCols = matrices[0].nCols();
 
             m_rankComputer.reset(numCols);
 
@@ -86,9 +97,9 @@ class ResolutionGapProjMerit<EmbeddingType::UNILEVEL>
             unsigned int merit = maxResolution; 
             for(unsigned int resolution = 0; resolution < maxResolution; ++resolution)
             {
-                for(auto coord : projection)
+                for(const auto& matrix : matrices)
                 {
-                    m_rankComputer.addRow(net.generatingMatrix(coord).subMatrix(resolution, 0, 1,numCols));
+                    m_rankComputer.addRow(matrix, resolution);
                 }
                 if(m_rankComputer.computeRank() == m_rankComputer.numRows())
                 {
@@ -161,10 +172,20 @@ class ResolutionGapProjMerit<EmbeddingType::MULTILEVEL>
          */ 
         Real operator()(const AbstractDigitalNet& net , const LatticeTester::Coordinates& projection) 
         {
-            Dimension dimension = projection.size();
+            const std::vector<const GeneratingMatrix*> matrices = net.generatingMatrices(projection);
+            return (*this)(ProjectionView(matrices));
+        }
+
+        /** 
+         * Computes the projection-dependent merit of the projection whose generating matrices are \c matrices.
+         * @param matrices Generating matrices of the projection.
+         */ 
+        Real operator()(ProjectionView matrices) 
+        {
+            Dimension dimension = matrices.size();
 
-            unsigned int numRows = net.numRows();
-            unsigned int numCols = net.numColumns();
+            unsigned int numRows = matrices[0].nRows();
+            unsigned int numCols = matrices[0].nCols();
 
             m_rankComputer.reset(numCols);
 
@@ -179,9 +200,9 @@ class ResolutionGapProjMerit<EmbeddingType::MULTILEVEL>
 
             for(unsigned int resolution = 0; resolution < maxResolution; ++resolution)
             {
-                for(auto coord : projection)
+                for(const auto& matrix : matrices)
                 {
-                    m_rankComputer.addRow(net.generatingMatrix(coord).subMatrix(resolution, 0,  1, numCols));
+                    m_rankComputer.addRow(matrix, resolution);
                 }
                 std::vector<unsigned int> ranks = m_rankComputer.computeRanks(0,numCols);
                 for(unsigned int m = 1; m <= numCols; ++m)
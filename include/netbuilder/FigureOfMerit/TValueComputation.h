@@ -23,6 +23,7 @@
 #define NETBUILDER__TVALUE_COMPUTATION_H
 
 #include "netbuilder/GeneratingMatrix.h"
+#include "netbuilder/ProjectionView.h"
 
 namespace NetBuilder {
 
@@ -42,7 +43,7 @@ namespace NetBuilder {
          * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
          * @param verbose Verbosity level.
          */ 
-        static unsigned int computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, int verbose);
+        static unsigned int computeTValue(ProjectionView baseMatrices, unsigned int maxTValuesSubProj, int verbose);
 
         /**
          * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level, using the prior knowledge that the maximum of the
@@ -51,7 +52,7 @@ namespace NetBuilder {
          * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
          * @param verbose Verbosity level.
          */ 
-        static std::vector<unsigned int> computeTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose)
+        static std::vector<unsigned int> computeTValue(ProjectionView baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose)
         {
             return computeTValue(baseMatrices, 0, maxTValuesSubProj, verbose);
         };
@@ -64,7 +65,60 @@ namespace NetBuilder {
          * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
          * @param verbose Verbosity level.
          */ 
-        static std::vector<unsigned int> computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int mMin, const std::vector<unsigned int>& maxTValuesSubProj, int verbose);
+        static std::vector<unsigned int> computeTValue(ProjectionView baseMatrices, unsigned int mMin, const std::vector<unsigned int>& maxTValuesSubProj, int verbose);
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, using the prior knowledge that the maximum of the
+         * t-values of the subprojections is \c maxTValuesSubProj.
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param verbose Verbosity level.
+         */ 
+        static unsigned int computeTValue(const std::vector<GeneratingMatrix>& baseMatrices, unsigned int maxTValuesSubProj, int verbose)
+        {
+            const std::vector<const GeneratingMatrix*> pointers = ProjectionView::pointersTo(baseMatrices);
+            return computeTValue(ProjectionView(pointers), maxTValuesSubProj, verbose);
+        }
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level, using the prior knowledge that the maximum of the
+         * t-values of the subprojections, for each level \c i is \c maxTValuesSubProj[i].
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param verbose Verbosity level.
+         */ 
+        static std::vector<unsigned int> computeTValue(const std::vector<GeneratingMatrix>& baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose)
+        {
+            const std::vector<const GeneratingMatrix*> pointers = ProjectionView::pointersTo(baseMatrices);
+            return computeTValue(ProjectionView(pointers), 0, maxTValuesSubProj, verbose);
+        }
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level greater or equal to \c mMin, using the prior knowledge that the maximum of the
+         * t-values of the subprojections, for each level <CODE> i + mMin </CODE> is \c maxTValuesSubProj[i]. We do not compute the t-value for the lower levels.
+         * @param baseMatrices Generating matrices.
+         * @param mMin Minimul level.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param verbose Verbosity level.
+         */
+        static std::vector<unsigned int> computeTValue(const std::vector<GeneratingMatrix>& baseMatrices, unsigned int mMin, const std::vector<unsigned int>& maxTValuesSubProj, int verbose)
+        {
+            const std::vector<const GeneratingMatrix*> pointers = ProjectionView::pointersTo(baseMatrices);
+            return computeTValue(ProjectionView(pointers), mMin, maxTValuesSubProj, verbose);
+        }
+
+        /**
+         * Sets the maximal number of threads used to compute a t-value. When the number of compositions to enumerate
+         * is large enough, the sequence of compositions is split into contiguous ranges which are evaluated concurrently.
+         * The computed t-values do not depend on the number of threads.
+         * @param numThreads Maximal number of threads (default: 1). If \c 0, all the hardware threads are used.
+         */
+        static void setNumThreads(unsigned int numThreads);
+
+        /**
+         * Returns the maximal number of threads used to compute a t-value.
+         */
+        static unsigned int numThreads();
     };
 
     /**
@@ -81,7 +135,29 @@ namespace NetBuilder {
          * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
          * @param verbose Verbosity level.
          */ 
-        static unsigned int computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxTValuesSubProj, int verbose);
+        static unsigned int computeTValue(ProjectionView baseMatrices, unsigned int maxTValuesSubProj, int verbose);
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level, using the prior knowledge that the maximum of the
+         * t-values of the subprojections, for each level \c i is \c maxTValuesSubProj[i].
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param verbose Verbosity level.
+         */ 
+        static std::vector<unsigned int> computeTValue(ProjectionView baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose);
+
+        /**
+         * Compute the t-value corresponding to the generating matrices \c baseMatrices, using the prior knowledge that the maximum of the
+         * t-values of the subprojections is \c maxTValuesSubProj.
+         * @param baseMatrices Generating matrices.
+         * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
+         * @param verbose Verbosity level.
+         */ 
+        static unsigned int computeTValue(const std::vector<GeneratingMatrix>& baseMatrices, unsigned int maxTValuesSubProj, int verbose)
+        {
+            const std::vector<const GeneratingMatrix*> pointers = ProjectionView::pointersTo(baseMatrices);
+            return computeTValue(ProjectionView(pointers), maxTValuesSubProj, verbose);
+        }
 
         /**
          * Compute the t-value corresponding to the generating matrices \c baseMatrices, for each level, using the prior knowledge that the maximum of the
@@ -90,7 +166,11 @@ namespace NetBuilder {
          * @param maxTValuesSubProj Maximum of the t-value of the subprojections.
          * @param verbose Verbosity level.
          */ 
-        static std::vector<unsigned int> computeTValue(std::vector<GeneratingMatrix> baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose);
+        static std::vector<unsigned int> computeTValue(const std::vector<GeneratingMatrix>& baseMatrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose)
+        {
+            const std::vector<const GeneratingMatrix*> pointers = ProjectionView::pointersTo(baseMatrices);
+            return computeTValue(ProjectionView(pointers), maxTValuesSubProj, verbose);
+        }
     };
 
 }
@@ -88,12 +88,8 @@ class TValueProjMerit<EmbeddingType::UNILEVEL, METHOD>
          */ 
         Real operator()(const AbstractDigitalNet& net , const LatticeTester::Coordinates& projection, SubProjCombination maxMeritsSubProj) const 
         {
-            std::vector<GeneratingMatrix> mats;
-            for(auto dim : projection)
-            {
-                mats.push_back(net.generatingMatrix(dim));
-            }
-            return METHOD::computeTValue(std::move(mats),maxMeritsSubProj, false);
+            const std::vector<const GeneratingMatrix*> matrices = net.generatingMatrices(projection);
+            return METHOD::computeTValue(ProjectionView(matrices), maxMeritsSubProj, false);
         }
 
         virtual Real combine(Merit merit, const AbstractDigitalNet& net, const LatticeTester::Coordinates& projection)
@@ -200,12 +196,8 @@ class TValueProjMerit<EmbeddingType::MULTILEVEL, METHOD>
          */ 
         std::vector<unsigned int> operator()(const AbstractDigitalNet& net, const LatticeTester::Coordinates& projection, const std::vector<unsigned int>& maxMeritsSubProj) const 
         {
-            std::vector<GeneratingMatrix> mats;
-            for(auto dim : projection)
-            {
-                mats.push_back(net.generatingMatrix(dim));
-            }
-            return METHOD::computeTValue(std::move(mats), maxMeritsSubProj, 0);
+            const std::vector<const GeneratingMatrix*> matrices = net.generatingMatrices(projection);
+            return METHOD::computeTValue(ProjectionView(matrices), maxMeritsSubProj, 0);
         }
 
         /** 
@@ -5,8 +5,10 @@
 #include "netbuilder/FigureOfMerit/ProjectionDependentEvaluator.h"
 #include "netbuilder/FigureOfMerit/LevelCombiner.h"
 #include "netbuilder/FigureOfMerit/Wafom/GetColsReverseCache.h"
+#include "netbuilder/FigureOfMerit/Wafom/PointSum.h"
 #include "latbuilder/Functor/LookUpTable.h"
 
+#include <algorithm>
 #include <functional>
 #include <stdexcept>
 #include <vector>
@@ -85,44 +87,42 @@ namespace NetBuilder
                 const uInteger numIteration = (1 << k);
                 const uInteger w = net.numRows();
                 const uInteger numPoints = net.numPoints();
-                const uInteger l = w / m_q;
                 double sum = 0.0;
+                if (w != (uInteger)m_table_c.numBits())
+                {
+                    throw std::invalid_argument("the number of rows of the net must be equal to the number of bits of the lookup table");
+                }
+                const std::vector<const GeneratingMatrix*> matrices = net.generatingMatrices(projection);
 
                 // std::cout << numIteration <<" *********************** " << numPoints << std::endl;
 
-                auto computeWAFOMRange = [&](int start, int end)
-                {
-                    GetColsReverseCache cache(net);
-                    double localSum = 0.0;
+                const GetColsReverseCache cache(matrices);
 
-                    uint64_t cachedCurPoint[projection.size()];
-                    int bit;
-                    double prod = 1.0;
-                    int j = -1;
+                auto computeWAFOMRange = [&](uInteger start, uInteger end, PointSum::CompensatedSum &localSum)
+                {
+                    const uInteger dim = projection.size();
+                    std::vector<uint64_t> block(GetColsReverseCache::PointsPerBlock * dim);
+                    std::vector<double> products(GetColsReverseCache::PointsPerBlock);
 
-                    for (auto i = start; i < end; i++)
+                    for (uInteger blockStart = start; blockStart < end; blockStart += GetColsReverseCache::PointsPerBlock)
                     {
-                        cache.getPointForProj( i, projection, cachedCurPoint);
-                        prod = 1.0;
-                        j = -1;
-                        for (auto dim : projection)
+                        const uInteger blockEnd = std::min<uInteger>(end, blockStart + GetColsReverseCache::PointsPerBlock);
+                        const uInteger count = blockEnd - blockStart;
+                        cache.getPoints(blockStart, count, block.data());
+
+                        std::fill_n(products.begin(), count, 1.0);
+                        for (uInteger j = 0; j < dim; j++)
                         {
-                            j++;
-                            uint64_t x_i = cachedCurPoint[j];
-
-                            for (uInteger c = 1; c <= m_q + (w % m_q != 0 ? 1 : 0); ++c)
-                            {
-                                int d_c = cache.compute_d_c(x_i, c, w, m_q); // d_c is the integer representation of the c-th segment of the i-th row vector.
-                                prod *= m_table_c.get(c, d_c);               // lookup_tables[c-1][d_c];
-                            }
+                            m_table_c.multiplyFactors(block.data() + j, count, dim, products.data());
+                        }
+                        for (uInteger p = 0; p < count; p++)
+                        {
+                            localSum.add(products[p] - 1.0);
                         }
-
-                        localSum += prod  - 1.0 ;
                     }
-                    return localSum;
                 };
 
-                sum = computeWAFOMRange(0, numIteration);
+                sum = PointSum::sum(numIteration, computeWAFOMRange);
 
                 return (sum / numPoints);
             }
@@ -1,6 +1,8 @@
 
 #ifndef NET_BUILDER__FIGURE_OF_MERIT__FASTWAFOM_H
 #define NET_BUILDER__FIGURE_OF_MERIT__FASTWAFOM_H
+#include <algorithm>
+#include <functional>
 #include <iostream>
 #include <vector>
 #include <array>
@@ -10,10 +12,15 @@
 #include <thread>
 #include <cstdint>
 #include <bitset>
+#include <limits>
+#include <stdexcept>
+#include <utility>
 
 #include "netbuilder/FigureOfMerit/FigureOfMerit.h"
 
 #include "netbuilder/FigureOfMerit/Wafom/GetColsReverseCache.h"
+#include "netbuilder/FigureOfMerit/Wafom/PointSum.h"
+#include "netbuilder/ProjectionView.h"
 #include "latbuilder/Storage.h"
 #include "latbuilder/Functor/LookUpTable.h"
 
@@ -74,6 +81,12 @@
  *
  * We use Kahan summation algorithm improves numerical accuracy by compensating
  * for floating-point errors, reducing round-off error accumulation.
+ *
+ * Since the WAFOM is a product over the coordinates, it can be evaluated in a
+ * CBC way: the evaluator keeps, for each point, the product of the factors of
+ * the coordinates of the best net so far, so that a candidate for the next
+ * coordinate only requires one multiplication per point and a sum over the
+ * points.
  **/
 
 namespace NetBuilder
@@ -81,7 +94,7 @@ namespace NetBuilder
     namespace FigureOfMerit
     {
 
-        class FastWafom : public FigureOfMerit
+        class FastWafom : public CBCFigureOfMerit
         {
         public:
             FastWafom(uInteger q, uInteger w, const LookUpTable &table_c) : m_q(std::move(q)), m_numRows(std::move(w)), m_table_c(table_c)
@@ -94,11 +107,23 @@ namespace NetBuilder
                 // }
             }
 
-            std::unique_ptr<FigureOfMeritEvaluator> createEvaluator() override
+            /**
+             * Returns a <code>std::unique_ptr</code> to an evaluator for the figure of merit.
+             */
+            virtual std::unique_ptr<CBCFigureOfMeritEvaluator> evaluator() override
             {
                 return std::make_unique<FastWafomEvaluator>(this, m_q, m_numRows, m_table_c);
             }
 
+            /**
+             * Creates a new accumulator.
+             * @param initialValue Initial accumulator value.
+             */
+            virtual Accumulator accumulator(Real initialValue) const override
+            {
+                return Accumulator(std::move(initialValue), 1);
+            }
+
             virtual std::string format() const override
             {
 
@@ -108,8 +133,169 @@ namespace NetBuilder
                 return res;
             }
 
+            /**
+             * Evaluator of the WAFOM of nets built column by column, as in Task::RandomSearchColumnByColumn.
+             *
+             * Appending a column to the generating matrices of a net with \f$2^c\f$ points leaves its points unchanged
+             * and adds the \f$2^c\f$ points of indices \f$2^c + i\f$, which are the points of index \f$i\f$ XORed
+             * with the new columns. The evaluator keeps the partial sums of the points of the accepted net (see
+             * PointSum::extendSum()), so that a candidate column only requires the terms of the new points.
+             * Several candidates can be evaluated in a single sweep over the points of the accepted net, which are then
+             * enumerated once for the whole batch.
+             * The merit values are the same, bit for bit, as those of FastWafom::evaluator() on the extended nets.
+             *
+             * The protocol mimics CBCFigureOfMeritEvaluator: candidates for the next column are evaluated with operator(),
+             * lastNetWasBest() is called after the evaluation of the best candidate so far, and prepareForNextColumn()
+             * appends the columns of the best candidate to the accepted net.
+             */
+            class ColumnEvaluator
+            {
+            public:
+                /**
+                 * Constructor.
+                 * @param table Lookup table of the figure of merit.
+                 * @param matrices Generating matrices of the accepted net, possibly without any column.
+                 */
+                ColumnEvaluator(const LookUpTable &table, const std::vector<GeneratingMatrix> &matrices) : m_table_c(table),
+                                                                                                          m_cache(matrices),
+                                                                                                          m_numPoints(uInteger(1) << (matrices.empty() ? 0 : matrices.front().nCols()))
+                {
+                    if (!matrices.empty() && matrices.front().nRows() != (unsigned int)m_table_c.numBits())
+                    {
+                        throw std::invalid_argument("the number of rows of the net must be equal to the number of bits of the lookup table");
+                    }
+                    // the points of the accepted net are the points of a batch with a single candidate without shift
+                    m_lastColumns.assign(1, std::vector<uInteger>(m_cache.numCoordinates(), 0));
+                    PointSum::extendSums(1, m_chunkSums, 0, m_numPoints, sumRange(0));
+                }
+
+                /**
+                 * Computes the WAFOM of the accepted net extended by one column.
+                 * @param newColumns Integer representations of the new columns, one for each coordinate,
+                 * with the first row as the most significant bit (see GeneratingMatrix::getColsReverse()).
+                 */
+                MeritValue operator()(const std::vector<uInteger> &newColumns)
+                {
+                    return (*this)(std::vector<std::vector<uInteger>>{newColumns}).front();
+                }
+
+                /**
+                 * Computes the WAFOM of the accepted net extended by each of several candidate columns,
+                 * in a single sweep over the points of the accepted net.
+                 * @param candidates New columns of each candidate, in the format of operator()(const std::vector<uInteger>&).
+                 */
+                std::vector<MeritValue> operator()(const std::vector<std::vector<uInteger>> &candidates)
+                {
+                    const unsigned int numCandidates = (unsigned int)candidates.size();
+                    m_lastColumns = candidates;
+                    m_lastChunkSums.resize(m_chunkSums.size() * numCandidates);
+                    for (size_t chunk = 0; chunk < m_chunkSums.size(); ++chunk)
+                    {
+                        std::fill_n(m_lastChunkSums.begin() + chunk * numCandidates, numCandidates, m_chunkSums[chunk]);
+                    }
+                    std::vector<double> sums = PointSum::extendSums(numCandidates, m_lastChunkSums, m_numPoints, 2 * m_numPoints, sumRange(m_numPoints));
+                    std::vector<MeritValue> merits(numCandidates);
+                    for (unsigned int b = 0; b < numCandidates; ++b)
+                    {
+                        merits[b] = sums[b] / (2 * m_numPoints);
+                    }
+                    return merits;
+                }
+
+                /**
+                 * Tells the evaluator that a candidate of the last batch was the best so far and keeps its columns and partial sums.
+                 * @param candidate Index of the candidate in the last batch.
+                 */
+                void lastNetWasBest(unsigned int candidate = 0)
+                {
+                    const size_t numCandidates = m_lastColumns.size();
+                    const size_t numChunks = m_lastChunkSums.size() / numCandidates;
+                    m_bestChunkSums.resize(numChunks);
+                    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+                    {
+                        m_bestChunkSums[chunk] = m_lastChunkSums[chunk * numCandidates + candidate];
+                    }
+                    m_bestColumns = m_lastColumns[candidate];
+                }
+
+                /**
+                 * Tells the evaluator that no more candidate will be evaluated for the current column,
+                 * and appends the columns of the best candidate to the accepted net.
+                 */
+                void prepareForNextColumn()
+                {
+                    m_cache.addColumns(m_bestColumns);
+                    m_chunkSums = std::move(m_bestChunkSums);
+                    m_bestChunkSums.clear();
+                    m_numPoints *= 2;
+                }
+
+            private:
+                const LookUpTable &m_table_c;
+                GetColsReverseCache m_cache; // columns of the accepted net
+                uInteger m_numPoints; // number of points of the accepted net
+                std::vector<PointSum::CompensatedSum> m_chunkSums; // partial sums of the accepted net
+                std::vector<PointSum::CompensatedSum> m_bestChunkSums; // partial sums of the best candidate so far
+                std::vector<PointSum::CompensatedSum> m_lastChunkSums; // partial sums of the candidates of the last batch, candidate-minor
+                std::vector<uInteger> m_bestColumns; // new columns of the best candidate so far
+                std::vector<std::vector<uInteger>> m_lastColumns; // new columns of the candidates of the last batch
+
+                // returns a function which adds, for each candidate b of the last batch, the terms of the points of indices start, ..., end - 1
+                // to sums[b], the point of index offset + i being the point of index i of the accepted net XORed with m_lastColumns[b]
+                std::function<void(uInteger, uInteger, PointSum::CompensatedSum *)> sumRange(uInteger offset) const
+                {
+                    return [this, offset](uInteger start, uInteger end, PointSum::CompensatedSum *sums)
+                    {
+                        const uInteger dim = m_cache.numCoordinates();
+                        std::vector<uint64_t> block(GetColsReverseCache::PointsPerBlock * dim);
+                        std::vector<uint64_t> shifted(GetColsReverseCache::PointsPerBlock * dim);
+                        std::vector<double> products(GetColsReverseCache::PointsPerBlock);
+
+                        for (uInteger blockStart = start; blockStart < end; blockStart += GetColsReverseCache::PointsPerBlock)
+                        {
+                            const uInteger blockEnd = std::min(end, blockStart + GetColsReverseCache::PointsPerBlock);
+                            const uInteger count = blockEnd - blockStart;
+                            // the points of the accepted net are shared by all the candidates
+                            m_cache.getPoints(blockStart - offset, count, block.data());
+
+                            for (size_t b = 0; b < m_lastColumns.size(); ++b)
+                            {
+                                const std::vector<uInteger> &shifts = m_lastColumns[b];
+                                for (uInteger p = 0; p < count; ++p)
+                                {
+                                    for (uInteger j = 0; j < dim; ++j)
+                                    {
+                                        shifted[p * dim + j] = block[p * dim + j] ^ shifts[j];
+                                    }
+                                }
+
+                                std::fill_n(products.begin(), count, 1.0);
+                                for (uInteger j = 0; j < dim; ++j)
+                                {
+                                    m_table_c.multiplyFactors(shifted.data() + j, count, dim, products.data());
+                                }
+                                for (uInteger p = 0; p < count; ++p)
+                                {
+                                    sums[b].add(products[p] - 1.0);
+                                }
+                            }
+                        }
+                    };
+                }
+            };
+
+            /**
+             * Returns a <code>std::unique_ptr</code> to an evaluator of the extensions by one column of the net with
+             * generating matrices \c matrices.
+             * @param matrices Generating matrices of the accepted net, possibly without any column.
+             */
+            std::unique_ptr<ColumnEvaluator> columnEvaluator(const std::vector<GeneratingMatrix> &matrices) const
+            {
+                return std::make_unique<ColumnEvaluator>(m_table_c, matrices);
+            }
+
         private:
-            class FastWafomEvaluator : public FigureOfMeritEvaluator
+            class FastWafomEvaluator : public CBCFigureOfMeritEvaluator
             {
             public:
                 FastWafomEvaluator(FastWafom *figure, uInteger q, uInteger w, const LookUpTable &table_c)
@@ -120,45 +306,127 @@ namespace NetBuilder
                     const uInteger numPoints = net.numPoints();
                     const uInteger w = net.numRows();
                     const uInteger dim = net.dimension();
-                    const uInteger l = w / m_q;
                     double sum = 0.0;
+                    if (w != (uInteger)m_table_c.numBits())
+                    {
+                        throw std::invalid_argument("the number of rows of the net must be equal to the number of bits of the lookup table");
+                    }
 
                     // Initialize cache with net
                     GetColsReverseCache cache(net);
 
-                    uint64_t point[dim];
-
-                    auto computeWAFOMRange = [&](uInteger start, uInteger end)
+                    auto computeWAFOMRange = [&](uInteger start, uInteger end, PointSum::CompensatedSum &localSum)
                     {
-                        double localSum = 0.0;
-                        double product = 1.0;
+                        std::vector<uint64_t> block(GetColsReverseCache::PointsPerBlock * dim);
+                        std::vector<double> products(GetColsReverseCache::PointsPerBlock);
 
-                        // Iterate over points to compute the WAFOM value
-                        for (uInteger i = start; i < end; ++i)
+                        // Iterate over blocks of consecutive points to compute the WAFOM value
+                        for (uInteger blockStart = start; blockStart < end; blockStart += GetColsReverseCache::PointsPerBlock)
                         {
-                            product = 1.0;
-                            cache.getPoint(i, dim, point);
+                            const uInteger blockEnd = std::min(end, blockStart + GetColsReverseCache::PointsPerBlock);
+                            const uInteger count = blockEnd - blockStart;
+                            cache.getPoints(blockStart, count, block.data());
 
+                            std::fill_n(products.begin(), count, 1.0);
                             for (uInteger j = 0; j < dim; ++j)
                             {
-                                uint64_t u_i_j = point[j];
-                                for (uInteger c = 1; c <= m_q + (w % m_q != 0 ? 1 : 0); ++c)
-                                {
-                                    uInteger d_c = cache.compute_d_c(u_i_j, c, w, m_q); 
-                                    product *= m_table_c.get(c, d_c);
-                                }
+                                m_table_c.multiplyFactors(block.data() + j, count, dim, products.data());
+                            }
+                            for (uInteger p = 0; p < count; ++p)
+                            {
+                                localSum.add(products[p] - 1.0);
                             }
-                            localSum += product - 1.0;
                         }
-                        return localSum;
                     };
 
-                    sum = computeWAFOMRange(0, numPoints);
+                    sum = PointSum::sum(numPoints, computeWAFOMRange);
 
                     return sum / numPoints;
                 }
 
-                virtual void reset() override {}
+                /**
+                 * Computes the WAFOM of the projection of \c net on its first <CODE>dimension + 1</CODE> coordinates,
+                 * reusing the products of the factors of the first \c dimension coordinates of the best net so far.
+                 * The value does not depend on \c initialValue, since the WAFOM is not a sum over the coordinates.
+                 * @param net Net to evaluate.
+                 * @param dimension Dimension to compute.
+                 * @param initialValue Merit of the first \c dimension coordinates (unused).
+                 * @param verbose Verbosity level.
+                 */
+                virtual MeritValue operator()(const AbstractDigitalNet &net, Dimension dimension, MeritValue initialValue, int verbose = 0) override
+                {
+                    const uInteger numPoints = net.numPoints();
+                    const uInteger w = net.numRows();
+                    if (w != (uInteger)m_table_c.numBits())
+                    {
+                        throw std::invalid_argument("the number of rows of the net must be equal to the number of bits of the lookup table");
+                    }
+                    if (m_memProducts.size() != numPoints)
+                    {
+                        m_memProducts.assign(numPoints, 1.0);
+                    }
+                    m_lastProducts.resize(numPoints);
+
+                    const GeneratingMatrix *matrix = &net.generatingMatrix(dimension);
+                    GetColsReverseCache cache(ProjectionView(&matrix, 1));
+
+                    auto computeWAFOMRange = [&](uInteger start, uInteger end, PointSum::CompensatedSum &localSum)
+                    {
+                        std::vector<uint64_t> block(GetColsReverseCache::PointsPerBlock);
+
+                        for (uInteger blockStart = start; blockStart < end; blockStart += GetColsReverseCache::PointsPerBlock)
+                        {
+                            const uInteger blockEnd = std::min(end, blockStart + GetColsReverseCache::PointsPerBlock);
+                            const uInteger count = blockEnd - blockStart;
+                            cache.getPoints(blockStart, count, block.data());
+
+                            double *products = m_lastProducts.data() + blockStart;
+                            std::copy_n(m_memProducts.begin() + blockStart, count, products);
+                            m_table_c.multiplyFactors(block.data(), count, 1, products);
+                            for (uInteger p = 0; p < count; ++p)
+                            {
+                                localSum.add(products[p] - 1.0);
+                            }
+                        }
+                    };
+
+                    double sum = PointSum::sum(numPoints, computeWAFOMRange);
+
+                    MeritValue merit = sum / numPoints;
+                    if (!onProgress()(merit)) // if someone is listening, may tell that the computation is useless
+                    {
+                        merit = std::numeric_limits<Real>::infinity();
+                        onAbort()(net);
+                    }
+                    return merit;
+                }
+
+                /**
+                 * Tells the evaluator that no more net will be evaluate for the current dimension,
+                 * and keeps the products of the best net for the next dimension.
+                 */
+                virtual void prepareForNextDimension() override
+                {
+                    m_memProducts = m_bestProducts;
+                }
+
+                /**
+                 * Tells the evaluator that the last net was the best so far and keeps its products.
+                 */
+                virtual void lastNetWasBest() override
+                {
+                    std::swap(m_bestProducts, m_lastProducts);
+                }
+
+                /**
+                 * Resets the evaluator and prepare it to evaluate a new net.
+                 */
+                virtual void reset() override
+                {
+                    m_memProducts.clear();
+                    m_bestProducts.clear();
+                    m_lastProducts.clear();
+                }
 
             private:
                 Dimension m_dimension;
@@ -166,6 +434,9 @@ namespace NetBuilder
                 uInteger m_q;
                 uInteger m_numRows;
                 const LookUpTable &m_table_c;
+                std::vector<double> m_memProducts;  // for each point, product of the factors of the coordinates of the best net for the previous dimension
+                std::vector<double> m_bestProducts; // for each point, product of the factors of the coordinates of the best net so far for the current dimension
+                std::vector<double> m_lastProducts; // for each point, product of the factors of the coordinates of the last net evaluated
             };
 
             uInteger m_q;
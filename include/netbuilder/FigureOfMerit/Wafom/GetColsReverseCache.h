@@ -8,23 +8,123 @@
 #include <boost/dynamic_bitset.hpp>
 #include "netbuilder/Types.h"
 #include "netbuilder/DigitalNet.h"
+#include "netbuilder/PackedGeneratingMatrix.h"
+#include "netbuilder/ProjectionView.h"
 #include "latbuilder/LFSR258.h"
 
 namespace NetBuilder
 {
 
+    /**
+     * Cache of the integer representations of the columns of generating matrices, used to enumerate the points of a digital net.
+     *
+     * Besides building a point from scratch (getPoint()), the cache can fill a contiguous block with consecutive points
+     * in the natural order of their indices (getPoints()), updating each coordinate with a single XOR per point.
+     */
     class GetColsReverseCache
     {
 
     public:
-        GetColsReverseCache(const AbstractDigitalNet &net) : m_net(net)
+        /// Number of points in the blocks filled by getPoints() in the WAFOM evaluators.
+        static constexpr uInteger PointsPerBlock = 256;
+
+        GetColsReverseCache(const AbstractDigitalNet &net)
         {
             int dim = net.dimension();
             columns.resize(dim); // Resize the columns vector
             for (int i = 0; i < dim; i++)
             {
-                auto matrix = m_net.generatingMatrix(i);
-                columns[i] = matrix.getColsReverse();
+                columns[i] = net.generatingMatrix(i).getColsReverse();
+            }
+            computeCumulativeColumns();
+        }
+
+        /***
+         * Builds the cache for the generating matrices of a projection, without copying the matrices.
+         * Coordinate j of the points is given by matrices[j].
+         * @param matrices: generating matrices of the projection
+         */
+        GetColsReverseCache(ProjectionView matrices)
+        {
+            columns.reserve(matrices.size());
+            for (const auto &matrix : matrices)
+            {
+                columns.push_back(matrix.getColsReverse());
+            }
+            computeCumulativeColumns();
+        }
+
+        /***
+         * Builds the cache for the generating matrices \c matrices.
+         * Coordinate j of the points is given by matrices[j].
+         * @param matrices: generating matrices
+         */
+        GetColsReverseCache(const std::vector<GeneratingMatrix> &matrices)
+        {
+            columns.reserve(matrices.size());
+            for (const auto &matrix : matrices)
+            {
+                columns.push_back(matrix.getColsReverse());
+            }
+            computeCumulativeColumns();
+        }
+
+        /**
+         * Appends a column to the generating matrix of each coordinate. The points of indices smaller than
+         * the former number of points are left unchanged.
+         * @param newColumns Integer representations of the new columns, one for each coordinate,
+         * with the first row as the most significant bit (see GeneratingMatrix::getColsReverse()).
+         */
+        void addColumns(const std::vector<uInteger> &newColumns)
+        {
+            for (size_t j = 0; j < columns.size(); j++)
+            {
+                const uInteger previous = cumulativeColumns[j].empty() ? 0 : cumulativeColumns[j].back();
+                columns[j].push_back(newColumns[j]);
+                cumulativeColumns[j].push_back(previous ^ newColumns[j]);
+            }
+        }
+
+        /**
+         * Returns the number of coordinates of the points.
+         */
+        unsigned int numCoordinates() const { return (unsigned int)columns.size(); }
+
+        /***
+         * Fills \c block with the \c count consecutive points starting at index \c first, in the natural order of the indices.
+         * Coordinate j of the point of index <CODE>first + p</CODE> is stored in <CODE>block[p * numCoordinates() + j]</CODE>.
+         * Only the first point is built from scratch. The indices i and i + 1 differ exactly in their bits 0, ..., c, where c is the
+         * number of trailing zeros of i + 1, so each subsequent point is obtained with a single XOR per coordinate.
+         * @param first: index of the first point
+         * @param count: number of points
+         * @param block: array of at least <CODE>count * numCoordinates()</CODE> elements to store the points
+         */
+        void getPoints(uInteger first, uInteger count, uint64_t block[]) const
+        {
+            const size_t dim = columns.size();
+            if (count == 0)
+            {
+                return;
+            }
+            for (size_t j = 0; j < dim; j++)
+            {
+                uint64_t res = 0;
+                for (size_t c = 0; c < columns[j].size(); c++)
+                {
+                    res ^= ((first >> c) & 1) * columns[j][c];
+                }
+                block[j] = res;
+            }
+            for (uInteger p = 1; p < count; ++p)
+            {
+                const unsigned int c = PackedGeneratingMatrix::countTrailingZeros(first + p);
+                const uint64_t *prev = block + (p - 1) * dim;
+                uint64_t *cur = block + p * dim;
+                for (size_t j = 0; j < dim; j++)
+                {
+                    const std::vector<uInteger> &cumul = cumulativeColumns[j];
+                    cur[j] = prev[j] ^ (c < cumul.size() ? cumul[c] : (cumul.empty() ? 0 : cumul.back()));
+                }
             }
         }
 
@@ -68,7 +168,7 @@ namespace NetBuilder
                 res = 0;
                 // const std::vector<uInteger> &getColsReverse = get(dim);
 
-                for (size_t c = 0; c < columns[j].size(); c++)
+                for (size_t c = 0; c < columns[dim].size(); c++)
                 {
                     // res ^= ((i >> c) & 1) * getColsReverse[c];
                      res ^= ((i >> c) & 1) * columns[dim][c];
@@ -111,10 +211,27 @@ namespace NetBuilder
 
     private:
         std::unordered_map<int, std::vector<uInteger>> cache;
-        const AbstractDigitalNet &m_net;
 
         std::vector<std::vector<uInteger>> columns;
 
+        // for each coordinate, cumulativeColumns[j][c] is the XOR of the columns 0, ..., c
+        std::vector<std::vector<uInteger>> cumulativeColumns;
+
+        void computeCumulativeColumns()
+        {
+            cumulativeColumns.resize(columns.size());
+            for (size_t j = 0; j < columns.size(); j++)
+            {
+                cumulativeColumns[j].resize(columns[j].size());
+                uInteger acc = 0;
+                for (size_t c = 0; c < columns[j].size(); c++)
+                {
+                    acc ^= columns[j][c];
+                    cumulativeColumns[j][c] = acc;
+                }
+            }
+        }
+
         /**
          * @param GeneratingMatrix matrix
          * @return  std::vector<uInteger>  the integer representations of the a column of a matrix
@@ -0,0 +1,186 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file defines the summation over the points of a digital net used by the WAFOM evaluators
+ */
+
+#ifndef NETBUILDER__FIGURE_OF_MERIT__WAFOM__POINT_SUM_H
+#define NETBUILDER__FIGURE_OF_MERIT__WAFOM__POINT_SUM_H
+
+#include "netbuilder/Types.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace NetBuilder { namespace FigureOfMerit {
+
+/**
+ * Summation of a term over the points of a digital net, used by the WAFOM evaluators.
+ *
+ * The points are split into chunks of PointsPerChunk consecutive points. The partial sum of each chunk is computed
+ * with compensated summation, and the chunks are distributed among several threads (see setNumThreads()).
+ * The partial sums are then added in the order of the chunks, again with compensated summation.
+ * Since the chunks do not depend on the number of threads, neither does the sum.
+ * The partial sums of the chunks can be kept to extend the sum to more points later on (see extendSum()).
+ */
+class PointSum
+{
+    public:
+
+        /// Number of points in the chunks whose partial sums are computed independently.
+        static constexpr uInteger PointsPerChunk = uInteger(1) << 14;
+
+        /**
+         * Compensated sum of floating-point numbers (Kahan-Babuska-Neumaier algorithm).
+         */
+        class CompensatedSum
+        {
+            public:
+                /** Adds \c x to the sum. */
+                void add(double x)
+                {
+                    double t = m_sum + x;
+                    if (std::abs(m_sum) >= std::abs(x))
+                    {
+                        m_compensation += (m_sum - t) + x;
+                    }
+                    else
+                    {
+                        m_compensation += (x - t) + m_sum;
+                    }
+                    m_sum = t;
+                }
+
+                /** Returns the sum. */
+                double value() const { return m_sum + m_compensation; }
+
+            private:
+                double m_sum = 0.0;
+                double m_compensation = 0.0;
+        };
+
+        /**
+         * Sets the maximal number of threads used to sum over the points.
+         * @param numThreads Maximal number of threads (default: 1). If \c 0, all the hardware threads are used.
+         */
+        static void setNumThreads(unsigned int numThreads);
+
+        /**
+         * Returns the maximal number of threads used to sum over the points.
+         */
+        static unsigned int numThreads();
+
+        /**
+         * Returns the sum of a term over the points of indices 0, ..., <CODE>numPoints - 1</CODE>.
+         * @param numPoints Number of points.
+         * @param sumRange Function such that <CODE>sumRange(start, end, sum)</CODE> adds the terms of the points
+         * of indices <CODE>start, ..., end - 1</CODE> to the compensated sum \c sum. It is called concurrently
+         * on disjoint ranges, whose bounds are multiples of PointsPerChunk, except for the last bound.
+         */
+        template <typename SUM_RANGE>
+        static double sum(uInteger numPoints, SUM_RANGE&& sumRange)
+        {
+            std::vector<CompensatedSum> chunkSums;
+            return extendSum(chunkSums, 0, numPoints, std::forward<SUM_RANGE>(sumRange));
+        }
+
+        /**
+         * Extends a sum over the points of indices 0, ..., <CODE>numPoints - 1</CODE> to the points of indices
+         * 0, ..., <CODE>newNumPoints - 1</CODE> and returns the new sum. Only the terms of the new points are computed.
+         * The result is the same as <CODE>sum(newNumPoints, sumRange)</CODE>, bit for bit.
+         * @param chunkSums Partial sums of the chunks of the first \c numPoints points, as left by a previous call
+         * (empty if \c numPoints is \c 0). On exit, partial sums of the chunks of the first \c newNumPoints points.
+         * @param numPoints Number of points already summed.
+         * @param newNumPoints Number of points of the new sum.
+         * @param sumRange Function such that <CODE>sumRange(start, end, sum)</CODE> adds the terms of the points
+         * of indices <CODE>start, ..., end - 1</CODE> to the compensated sum \c sum. It is called concurrently
+         * on disjoint ranges, whose bounds are multiples of PointsPerChunk, except for the first and the last bounds.
+         */
+        template <typename SUM_RANGE>
+        static double extendSum(std::vector<CompensatedSum>& chunkSums, uInteger numPoints, uInteger newNumPoints, SUM_RANGE&& sumRange)
+        {
+            return extendSums(1, chunkSums, numPoints, newNumPoints,
+                [&sumRange](uInteger start, uInteger end, CompensatedSum* sums) { sumRange(start, end, sums[0]); }).front();
+        }
+
+        /**
+         * Extends \c numSums sums over the points of indices 0, ..., <CODE>numPoints - 1</CODE> to the points of indices
+         * 0, ..., <CODE>newNumPoints - 1</CODE> in a single sweep over the new points, and returns the new sums.
+         * Each sum is the same, bit for bit, as if it were extended on its own with extendSum().
+         * @param numSums Number of sums.
+         * @param chunkSums Partial sums of the chunks of the first \c numPoints points, as left by a previous call
+         * (empty if \c numPoints is \c 0): the partial sum of sum \c s over chunk \c c is <CODE>chunkSums[c * numSums + s]</CODE>.
+         * On exit, partial sums of the chunks of the first \c newNumPoints points.
+         * @param numPoints Number of points already summed.
+         * @param newNumPoints Number of points of the new sums.
+         * @param sumRange Function such that <CODE>sumRange(start, end, sums)</CODE> adds the terms of the points
+         * of indices <CODE>start, ..., end - 1</CODE> to the compensated sums <CODE>sums[0], ..., sums[numSums - 1]</CODE>.
+         * It is called concurrently on disjoint ranges, whose bounds are multiples of PointsPerChunk, except for the first
+         * and the last bounds.
+         */
+        template <typename SUM_RANGE>
+        static std::vector<double> extendSums(unsigned int numSums, std::vector<CompensatedSum>& chunkSums, uInteger numPoints, uInteger newNumPoints, SUM_RANGE&& sumRange)
+        {
+            const uInteger firstChunk = numPoints / PointsPerChunk;
+            const uInteger numChunks = (newNumPoints + PointsPerChunk - 1) / PointsPerChunk;
+            chunkSums.resize(numChunks * numSums);
+            std::atomic<uInteger> nextChunk(firstChunk);
+
+            auto worker = [&]()
+            {
+                uInteger chunk;
+                while ((chunk = nextChunk.fetch_add(1)) < numChunks)
+                {
+                    sumRange(std::max(numPoints, chunk * PointsPerChunk), std::min(newNumPoints, (chunk + 1) * PointsPerChunk), chunkSums.data() + chunk * numSums);
+                }
+            };
+
+            const unsigned int threads = (unsigned int) std::min<uInteger>(numThreads(), numChunks - std::min(firstChunk, numChunks));
+            std::vector<std::thread> workers;
+            for (unsigned int t = 1; t < threads; ++t)
+            {
+                workers.emplace_back(worker);
+            }
+            worker();
+            for (auto& thread : workers)
+            {
+                thread.join();
+            }
+
+            std::vector<double> res(numSums);
+            for (unsigned int s = 0; s < numSums; ++s)
+            {
+                CompensatedSum total;
+                for (uInteger chunk = 0; chunk < numChunks; ++chunk)
+                {
+                    total.add(chunkSums[chunk * numSums + s].value());
+                }
+                res[s] = total.value();
+            }
+            return res;
+        }
+};
+
+}}
+
+#endif
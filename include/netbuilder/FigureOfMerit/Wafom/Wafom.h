@@ -1,6 +1,7 @@
 #ifndef NET_BUILDER__FIGURE_OF_MERIT__Wafom_H
 #define NET_BUILDER__FIGURE_OF_MERIT__Wafom_H
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <numeric>
@@ -15,6 +16,7 @@
 
 #include "netbuilder/FigureOfMerit/FigureOfMerit.h"
 #include "netbuilder/FigureOfMerit/Wafom/GetColsReverseCache.h"
+#include "netbuilder/FigureOfMerit/Wafom/PointSum.h"
 
 /**
  * This class calculates the Walsh Figure of Merit (WAFOM) for a Digital Net Base 2.
@@ -104,37 +106,47 @@ namespace NetBuilder
                     const int s = net.dimension();
                     GetColsReverseCache cache(net);
 
+                    // factors of the bits: bitFactors[2 * (l - 1) + bit] = 1 + (-1)^bit * 2^(-factor * (l + h))
+                    std::vector<double> bitFactors(2 * w);
+                    for (int l = 1; l <= w; ++l)
+                    {
+                        double two_exponent = std::pow(2.0, -(factor * (l + h)));
+                        bitFactors[2 * (l - 1)] = 1 + two_exponent;
+                        bitFactors[2 * (l - 1) + 1] = 1 - two_exponent;
+                    }
+
                     // Define a lambda function to compute WAFOM for a range of points
-                    auto computeWAFOMRange = [&](int start, int end)
+                    auto computeWAFOMRange = [&](uInteger start, uInteger end, PointSum::CompensatedSum &localSum)
                     {
-                        double localSum = 0.0;
                         double prod = 1.0;
-                        size_t dim = net.dimension();
-                        uint64_t cachedCurPoint[dim];
+                        std::vector<uint64_t> block(GetColsReverseCache::PointsPerBlock * s);
                         int bit;
 
-                        for (int i = start; i < end; ++i)
+                        for (uInteger blockStart = start; blockStart < end; blockStart += GetColsReverseCache::PointsPerBlock)
                         {
-                            prod = 1.0;
+                            const uInteger blockEnd = std::min<uInteger>(end, blockStart + GetColsReverseCache::PointsPerBlock);
+                            cache.getPoints(blockStart, blockEnd - blockStart, block.data());
 
-                            cache.getPoint(i, s, cachedCurPoint);
-                            for (int j = 0; j < s; ++j)
+                            for (uInteger i = blockStart; i < blockEnd; ++i)
                             {
+                                prod = 1.0;
 
-                                for (int l = 1; l <= w; ++l)
+                                const uint64_t *cachedCurPoint = block.data() + (i - blockStart) * s;
+                                for (int j = 0; j < s; ++j)
                                 {
-                                    bit = ((cachedCurPoint[j] >> (w - l)) & 1);
 
-                                    double two_exponent = std::pow(2.0, -(factor * (l + h)));
-                                    prod *= (1 + (1 - 2 * bit) * two_exponent);
+                                    for (int l = 1; l <= w; ++l)
+                                    {
+                                        bit = ((cachedCurPoint[j] >> (w - l)) & 1);
+                                        prod *= bitFactors[2 * (l - 1) + bit];
+                                    }
                                 }
+                                localSum.add(prod - 1.0);
                             }
-                            localSum += prod - 1.0;
                         }
-                        return localSum;
                     };
 
-                    sum = computeWAFOMRange(0, numPoints);
+                    sum = PointSum::sum(numPoints, computeWAFOMRange);
 
                     return (sum / numPoints);
                 }
@@ -33,6 +33,8 @@
 
 namespace NetBuilder {
 
+class PackedGeneratingMatrix;
+
 /** This class implements a generating matrix of a digital net in base 2.
  * 
  * Internally, a matrix is represented as a <code>std::vector</code> of rows implemented by
@@ -218,6 +220,8 @@ class GeneratingMatrix {
             return mat;
         }
     private:
+        friend class PackedGeneratingMatrix;
+
         std::vector<boost::dynamic_bitset<>> m_data; // data internal representantion
         unsigned int m_nRows; // number of rows of the matrix
         unsigned int m_nCols; // number of columns of the matrix
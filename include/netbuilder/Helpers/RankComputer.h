@@ -17,16 +17,16 @@
 /**
  * \file
  * This file defines a class which computes the rank of matrices in \f$ F_2 \f$ using the gaussian elimination
- */ 
+ */
 
 #ifndef NETBUILDER__RANK_COMPUTER_H
 #define NETBUILDER__RANK_COMPUTER_H
 
 #include "netbuilder/GeneratingMatrix.h"
+#include "netbuilder/PackedGeneratingMatrix.h"
 
 #include <map>
-#include <set>
-#include <list>
+#include <vector>
 
 // #define DEBUG_ROW_REDUCER
 
@@ -34,120 +34,223 @@ namespace NetBuilder {
 
 /**
  * Class used to perform row reduction operations on a matrix.
- */ 
+ *
+ * The reduced matrix and the row operations matrix are stored as word-packed matrices
+ * (see PackedGeneratingMatrix) whose shape is the capacity of the rank computer, and the pivots are tracked
+ * with flat arrays and bitmasks over the rows and the columns. Once the capacity is large enough
+ * (see reserve()), adding rows, adding columns and replacing rows do not allocate memory.
+ */
 class RankComputer
 {
     public:
+
+        /// Type for the words of the bitmasks.
+        typedef PackedGeneratingMatrix::Word Word;
+
         /** Constructor.
          * @param nCols number of columns of the rank computer.
-         */ 
+         */
         RankComputer(unsigned int nCols = 0);
 
         /**
          * Clears the rank computer and set the number of columns to \c nCols.
+         * The capacity is kept.
          * @param nCols New number of columns of the rank computer.
-         */ 
+         */
         void reset(unsigned int nCols);
-        
+
+        /**
+         * Makes sure that the rank computer can hold \c nRows rows and \c nCols columns without allocating memory.
+         * @param nRows Number of rows.
+         * @param nCols Number of columns.
+         */
+        void reserve(unsigned int nRows, unsigned int nCols);
+
         /**
          * Adds a row below the current matrix and updates the reduction subsequently.
          * @param newRow The one-row matrix to stack below.
-         */ 
+         */
         void addRow(GeneratingMatrix newRow);
 
+        /**
+         * Adds the row at position \c rowIndex of \c matrix below the current matrix and updates the reduction subsequently.
+         * @param matrix Matrix containing the row to stack below. Columns beyond numCols() are ignored.
+         * @param rowIndex Index of the row in \c matrix.
+         */
+        void addRow(const PackedGeneratingMatrix& matrix, unsigned int rowIndex);
+
+        /**
+         * Adds the row at position \c rowIndex of \c matrix below the current matrix and updates the reduction subsequently.
+         * The row is not copied into an intermediate matrix.
+         * @param matrix Matrix containing the row to stack below. Columns beyond numCols() are ignored.
+         * @param rowIndex Index of the row in \c matrix.
+         */
+        void addRow(const GeneratingMatrix& matrix, unsigned int rowIndex);
+
         /**
          * Adds a column on the right to the current matrix and updates the reduction subsequently.
          * @param newCol The one-column matrix to stack on the right.
-         */ 
+         */
         void addColumn(GeneratingMatrix newCol);
 
+        /**
+         * Adds a column on the right to the current matrix and updates the reduction subsequently.
+         * @param newCol Words containing the numRows() bits of the new column. The element in row \c i is
+         * the bit <code>i % 64</code> of the word <code>i / 64</code>.
+         */
+        void addColumn(const Word* newCol);
+
         /**
          * Replaces the row in position \c rowIndex by \c newRow.
          * @param rowIndex Index of the row to discard.
          * @param newRow Replacement row.
          * @param verbose Verbosity level.
-         */ 
+         */
         void replaceRow(unsigned int rowIndex, GeneratingMatrix&& newRow, int verbose = 0);
 
-        /** 
+        /**
+         * Replaces the row in position \c rowIndex by the row at position \c matrixRowIndex of \c matrix.
+         * @param rowIndex Index of the row to discard.
+         * @param matrix Matrix containing the replacement row. Columns beyond numCols() are ignored.
+         * @param matrixRowIndex Index of the replacement row in \c matrix.
+         * @param verbose Verbosity level.
+         */
+        void replaceRow(unsigned int rowIndex, const PackedGeneratingMatrix& matrix, unsigned int matrixRowIndex, int verbose = 0);
+
+        /**
          * Computes the rank of the matrix.
-         */ 
-        unsigned int computeRank() const;
+         */
+        unsigned int computeRank() const { return m_rank; }
 
-        /** 
+        /**
          * Computes the ranks of the submatrices with an increasing number of columns.
          * @param firstCol Index of the the last column of the first submatrix.
          * @param numCol Number of submatrices to consider.
-         */ 
+         */
         std::vector<unsigned int> computeRanks(unsigned int firstCol, unsigned int numCol) const;
 
-        /** 
+        /**
          * Returns the minimal number of columns necessary for the system spanned by the rows to be of full rank.
          * Returns nCols() + 1 if the system is not of full rank even if all the columns are taken.
-         */ 
+         */
         unsigned int smallestFullRank() { return m_smallestFullRank; }
 
         /**
          * Returns a const reference to the row-reduced matrix.
-         */ 
-        const GeneratingMatrix& reducedMatrix() const {return m_redMat;}
+         * The matrix is allocated at the capacity of the rank computer: only its
+         * first numRows() rows and numCols() columns are meaningful.
+         */
+        const PackedGeneratingMatrix& reducedMatrix() const { return m_redMat; }
 
         /**
          * Returns a const reference to the row operations matrix.
-         */ 
-        const GeneratingMatrix& rowOperations() const {return m_rowOperations; }
+         * The matrix is allocated at the capacity of the rank computer: only its
+         * first numRows() rows and numRows() columns are meaningful.
+         */
+        const PackedGeneratingMatrix& rowOperations() const { return m_rowOperations; }
+
+        /**
+         * Returns a copy of the row-reduced matrix with numRows() rows and numCols() columns.
+         */
+        PackedGeneratingMatrix reducedMatrixCopy() const { return m_redMat.upperLeftSubMatrix(m_nRows, m_nCols); }
+
+        /**
+         * Returns a copy of the row operations matrix with numRows() rows and numRows() columns.
+         */
+        PackedGeneratingMatrix rowOperationsCopy() const { return m_rowOperations.upperLeftSubMatrix(m_nRows, m_nRows); }
 
         /**
          * Returns the number of rows in the rank computer.
-         */ 
+         */
         unsigned int numRows() const {return m_nRows; }
 
         /**
          * Returns the number of columns in the rank computer.
-         */ 
+         */
         unsigned int numCols() const {return m_nCols; }
 
         /**
          * Returns a map of pivot positions (key: row index, value: column index).
-         */ 
-        std::map<unsigned int, unsigned int> getPivots() const {return m_pivotsRowColPositions; }
+         */
+        std::map<unsigned int, unsigned int> getPivots() const;
 
         /**
-         * Check if a matrix is invertible. Returns false if the matrix is not-square or singular, 
+         * Check if a matrix is invertible. Returns false if the matrix is not-square or singular,
          * and true otherwise.
-         */ 
+         */
         static bool checkIfInvertible(GeneratingMatrix matrix) ;
-        
+
         #ifdef DEBUG_ROW_REDUCER
         void check();
-        const GeneratingMatrix& baseMatrix() const {return m_baseMatrix;}
+        PackedGeneratingMatrix baseMatrixCopy() const {return m_baseMatrix.upperLeftSubMatrix(m_nRows, m_nCols);}
         #endif
 
 
     private:
-    
+
+        static constexpr unsigned int NoPivot = static_cast<unsigned int>(-1); // marker for rows and columns without a pivot
+
         unsigned int m_nRows = 0; // number of rows in the rank computer
-        unsigned int m_nCols; // number of columns of the rank computer
+        unsigned int m_nCols = 0; // number of columns of the rank computer
+        unsigned int m_rowCapacity = 0; // number of rows which can be held without allocation
+        unsigned int m_colCapacity = 0; // number of columns which can be held without allocation
+        unsigned int m_rank = 0; // number of pivots
         unsigned int m_smallestFullRank; // minimal number of columns necessary for the system spanned by the rows to be full-rank.
-        GeneratingMatrix m_redMat; // row-reduced matrix
-        GeneratingMatrix m_rowOperations; // row operations matrix
-        std::map<unsigned int, unsigned int> m_pivotsColRowPositions; // columns index are the keys and rows indexes are the values
-        std::map<unsigned int, unsigned int> m_pivotsRowColPositions; // columns index are the keys and rows indexes are the values
-        std::set<unsigned int> m_columnsWithoutPivot; // ordered set for columns without a pivot
-        std::list<unsigned int> m_rowsWithoutPivot; // list of rows without a pivot 
+        PackedGeneratingMatrix m_redMat; // row-reduced matrix (m_rowCapacity x m_colCapacity)
+        PackedGeneratingMatrix m_rowOperations; // row operations matrix (m_rowCapacity x m_rowCapacity)
+        std::vector<unsigned int> m_pivotRowOfCol; // for each column, row index of its pivot or NoPivot
+        std::vector<unsigned int> m_pivotColOfRow; // for each row, column index of its pivot or NoPivot
+        std::vector<Word> m_colsWithPivot; // bitmask of the columns with a pivot
+        std::vector<Word> m_rowsWithPivot; // bitmask of the rows with a pivot
+        std::vector<Word> m_colBuffer; // work buffer for the columns added by addColumn
         #ifdef DEBUG_ROW_REDUCER
-        GeneratingMatrix m_baseMatrix;
+        PackedGeneratingMatrix m_baseMatrix;
         #endif
 
+        /**
+         * Copies the first numCols() columns of row \c matrixRowIndex of \c matrix into row \c rowIndex of the reduced matrix.
+         */
+        void copyRow(unsigned int rowIndex, const PackedGeneratingMatrix& matrix, unsigned int matrixRowIndex);
+
+        /**
+         * Copies the first numCols() columns of row \c matrixRowIndex of \c matrix into row \c rowIndex of the reduced matrix.
+         */
+        void copyRow(unsigned int rowIndex, const GeneratingMatrix& matrix, unsigned int matrixRowIndex);
+
+        /**
+         * Sets to zero the elements of row \c rowIndex of the reduced matrix beyond the numCols() first columns.
+         */
+        void clearColumnsBeyondEnd(unsigned int rowIndex);
+
+        /**
+         * Appends a null row to the matrix and returns its index.
+         */
+        unsigned int appendRow();
+
+        /**
+         * Reduces the row appended at position \c row and updates the pivots and the smallest full rank.
+         */
+        void reduceAppendedRow(unsigned int row);
+
+        /**
+         * Records a pivot at position \c row, \c col.
+         */
+        void setPivot(unsigned int row, unsigned int col);
+
+        /**
+         * Removes the pivot of column \c col, if any.
+         */
+        void removePivotOfCol(unsigned int col);
+
         /**
          * Uses existing pivots to pivot the row at position \c rowIndex and look for
          * a new pivot on this row. If such a pivot exists, uses it to pivot the other rows.
          * @param rowIndex Index of the row.
-         */ 
+         */
         unsigned int pivotRowAndFindNewPivot(unsigned int rowIndex);
 
 };
 
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -71,7 +71,7 @@ namespace NetBuilder {
  *  to the embedding type of the point set and template parameter RAND implements
  *  a C++11-style PRNG. This is a random generator of generating values. This class template must define a constructor 
  *  <CODE> RandomGenValueGenerator(SizeParameter sizeParameter, RAND randomGen = RAND()) </CODE> and an the member function <CODE>GenValue operator()(Dimension coord)</CODE> returning
- *  a generating value for coordinate \c coord.
+ *  a generating value for coordinate \c coord, and the member function <CODE>RAND& randomGenerator()</CODE> returning the underlying PRNG.
  */ 
 template <NetConstruction NC>
 struct NetConstructionTraits;
@@ -190,6 +190,11 @@ struct NetConstructionTraits<NetConstruction::SOBOL>
                 return GenValue(coord,std::move(res));
             }
 
+            /**
+             * Returns the underlying random generator.
+             */
+            RAND& randomGenerator() { return m_randomGen; }
+
         private:
             SizeParameter m_sizeParameter;
             RAND m_randomGen;
@@ -256,6 +261,12 @@ struct NetConstructionTraits<NetConstruction::POLYNOMIAL>
                     return m_generatingValues[m_unif(m_randomGen)];
                 }
             }
+
+            /**
+             * Returns the underlying random generator.
+             */
+            RAND& randomGenerator() { return m_randomGen; }
+
         private:
             RAND m_randomGen;
             LatBuilder::GenSeq::GeneratingValues<LatBuilder::LatticeType::POLYNOMIAL, LatBuilder::Compress::NONE> m_generatingValues;
@@ -329,6 +340,11 @@ struct NetConstructionTraits<NetConstruction::EXPLICIT>
                 return matrix;
             }
 
+            /**
+             * Returns the underlying random generator.
+             */
+            RAND& randomGenerator() { return m_randomGen; }
+
         private:
             SizeParameter m_sizeParameter;
             RAND m_randomGen;
@@ -357,6 +373,11 @@ struct NetConstructionTraits<NetConstruction::EXPLICIT>
                 return GeneratingMatrix(m_sizeParameter.first, m_sizeParameter.second, std::move(init));
             }
 
+            /**
+             * Returns the underlying random generator.
+             */
+            RAND& randomGenerator() { return m_randomGen; }
+
         private:
             SizeParameter m_sizeParameter;
             RAND m_randomGen;
@@ -410,6 +431,11 @@ struct NetConstructionTraits<NetConstruction::LMS>
                 return GeneratingMatrix::createRandomLowerTriangularMatrix(m_sizeParameter.first.first, m_sizeParameter.first.second, m_randomGen);
             }
 
+            /**
+             * Returns the underlying random generator.
+             */
+            RAND& randomGenerator() { return m_randomGen; }
+
         private:
             SizeParameter m_sizeParameter;
             RAND m_randomGen;
@@ -429,6 +455,11 @@ struct NetConstructionTraits<NetConstruction::LMS>
                 return GeneratingMatrix::createRandomLowerTriangularMatrix(m_sizeParameter.first.first, m_sizeParameter.first.second, m_randomGen);
             }
 
+            /**
+             * Returns the underlying random generator.
+             */
+            RAND& randomGenerator() { return m_randomGen; }
+
         private:
             SizeParameter m_sizeParameter;
             RAND m_randomGen;
@@ -0,0 +1,301 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file contains the definition of word-packed generating matrices in base 2
+ */
+
+#ifndef NETBUILDER__PACKED_GENERATING_MATRIX_H
+#define NETBUILDER__PACKED_GENERATING_MATRIX_H
+
+#include "netbuilder/GeneratingMatrix.h"
+
+#include <cstdint>
+#include <vector>
+#include <iostream>
+#include <string>
+
+namespace NetBuilder {
+
+/** This class implements a generating matrix of a digital net in base 2 stored in a contiguous,
+ * word-packed array.
+ *
+ * Each row is stored as a fixed number of 64-bit words, and all rows are stored one after the other
+ * in a single <code>std::vector</code>. Column \c j of a row is the bit <code>j % 64</code> of the word <code>j / 64</code>,
+ * which is the same convention as the one used by <code>boost::dynamic_bitset</code> in GeneratingMatrix.
+ * For matrices with at most 64 columns (the usual case), a row is a single machine word, so that row
+ * operations (XOR, swap, test for zero, search of the first non-zero entry) are single instructions.
+ *
+ * This class has the same public interface as GeneratingMatrix, except that rows are exposed as pointers to
+ * their first word. It is used internally by the rank computations (see RankComputer) and the t-value
+ * computations (see GaussMethod and SchmidMethod).
+ * Bits beyond the last column of each row are always kept equal to zero.
+ */
+class PackedGeneratingMatrix {
+
+    public:
+
+        /// Type for the words storing the rows.
+        typedef uint64_t Word;
+
+        /// Number of bits in a word.
+        static constexpr unsigned int WordSize = 64;
+
+        /// Type for unsigned long.
+        typedef GeneratingMatrix::uInteger uInteger;
+
+        /** Proxy to a single element of the matrix. */
+        class reference {
+            public:
+                reference(Word* word, Word mask): m_word(word), m_mask(mask) {}
+
+                operator bool() const { return (*m_word & m_mask) != 0; }
+
+                reference& operator=(bool value)
+                {
+                    if (value) { *m_word |= m_mask; } else { *m_word &= ~m_mask; }
+                    return *this;
+                }
+
+                reference& operator=(const reference& other) { return (*this) = (bool) other; }
+
+                reference& operator^=(bool value) { if (value) { *m_word ^= m_mask; } return *this; }
+
+                void flip() { *m_word ^= m_mask; }
+
+            private:
+                Word* m_word;
+                Word m_mask;
+        };
+
+        /** Constructs a generating matrix with all entries set to zero.
+         * @param nRows Number of rows.
+         * @param nCols Number of columns.
+         */
+        PackedGeneratingMatrix(unsigned int nRows = 0, unsigned int nCols = 0);
+
+        /** Constructs a generating matrix with rows initialized
+         * using the given integers. The elements of a row
+         * are the binary digits of the corresponding integer,
+         * with the least significant bit on the left.
+         * @param nRows Number of rows.
+         * @param nCols Number of columns.
+         * @param init  Vector of uInteger of length nRows
+         */
+        PackedGeneratingMatrix(unsigned int nRows, unsigned int nCols, const std::vector<uInteger>& init);
+
+        /** Constructs a packed copy of \c matrix.
+         * @param matrix Generating matrix to copy.
+         */
+        explicit PackedGeneratingMatrix(const GeneratingMatrix& matrix);
+
+        /** Returns a copy of the matrix using the GeneratingMatrix representation. */
+        GeneratingMatrix toGeneratingMatrix() const;
+
+        /** Returns the number of columns of the matrix. */
+        unsigned int nCols() const { return m_nCols; }
+
+        /** Returns the number of rows of the matrix. */
+        unsigned int nRows() const { return m_nRows; }
+
+        /** Returns the number of words used to store each row. */
+        unsigned int nWordsPerRow() const { return m_nWords; }
+
+        /** Returns the number of words necessary to store \c nCols bits.
+         * @param nCols Number of columns.
+         */
+        static unsigned int nWords(unsigned int nCols) { return (nCols + WordSize - 1) / WordSize; }
+
+        /** Resizes the matrix to the given shape. Potential new elements are set to zero.
+         * @param nRows is the new number of rows of the matrix
+         * @param nCols is the new number of columns of the matrix
+         */
+        void resize(unsigned int nRows, unsigned int nCols);
+
+        /** Returns the element at position \c i, \c j of the matrix.
+         * @param i Row index.
+         * @param j Column index.
+         */
+        bool operator()(unsigned int i, unsigned int j) const
+        {
+            return (m_data[i * m_nWords + j / WordSize] >> (j % WordSize)) & 1;
+        }
+
+        /** Returns a reference to the element at position \c i, \c j of the matrix.
+         * @param i Row index.
+         * @param j Column index.
+         */
+        reference operator()(unsigned int i, unsigned int j)
+        {
+            return reference(&m_data[i * m_nWords + j / WordSize], Word(1) << (j % WordSize));
+        }
+
+        /** Flip the element at at position \c i, \c j of the matrix.
+         * @param i Row index.
+         * @param j Column index.
+         */
+        void flip(unsigned int i, unsigned int j)
+        {
+            m_data[i * m_nWords + j / WordSize] ^= Word(1) << (j % WordSize);
+        }
+
+        /** Returns a pointer to the first word of the row at position \c i of the matrix.
+         * @param i Position of the row.
+         */
+        const Word* operator[](unsigned int i) const { return m_data.data() + i * m_nWords; }
+
+        /** Returns a pointer to the first word of the row at position \c i of the matrix.
+         * @param i Position of the row.
+         */
+        Word* operator[](unsigned int i) { return m_data.data() + i * m_nWords; }
+
+        /** Adds (XOR) the row at position \c src to the row at position \c dest.
+         * @param dest Position of the modified row.
+         * @param src Position of the added row.
+         */
+        void xorRow(unsigned int dest, unsigned int src)
+        {
+            Word* d = (*this)[dest];
+            const Word* s = (*this)[src];
+            for (unsigned int w = 0; w < m_nWords; ++w)
+            {
+                d[w] ^= s[w];
+            }
+        }
+
+        /** Sets all the elements of the row at position \c i to zero.
+         * @param i Position of the row.
+         */
+        void resetRow(unsigned int i)
+        {
+            Word* d = (*this)[i];
+            for (unsigned int w = 0; w < m_nWords; ++w)
+            {
+                d[w] = 0;
+            }
+        }
+
+        /** Sets the row at position \c i to the row at position \c matrixRowIndex of \c matrix.
+         * Columns of \c matrix beyond nCols() are ignored, and missing columns are set to zero.
+         * @param i Position of the row.
+         * @param matrix Matrix containing the new row.
+         * @param matrixRowIndex Position of the new row in \c matrix.
+         */
+        void setRow(unsigned int i, const GeneratingMatrix& matrix, unsigned int matrixRowIndex);
+
+        /** Returns the index of the first non-zero element of the row at position \c i,
+         * or nCols() if the row is null.
+         * @param i Position of the row.
+         */
+        unsigned int findFirstInRow(unsigned int i) const
+        {
+            const Word* r = (*this)[i];
+            for (unsigned int w = 0; w < m_nWords; ++w)
+            {
+                if (r[w])
+                {
+                    return w * WordSize + countTrailingZeros(r[w]);
+                }
+            }
+            return m_nCols;
+        }
+
+        /** Returns the number of trailing zeros of a non-zero word.
+         * @param word Non-zero word.
+         */
+        static unsigned int countTrailingZeros(Word word)
+        {
+            #if defined(__GNUC__)
+            return (unsigned int) __builtin_ctzll(word);
+            #else
+            unsigned int res = 0;
+            while (!(word & 1))
+            {
+                word >>= 1;
+                ++res;
+            }
+            return res;
+            #endif
+        }
+
+        /** Returns the upper-left submatrix with \c nRows rows and \c nCols columns.
+         * @param nRows Number of rows.
+         * @param nCols Number of columns.
+         * @return A copy of the submatrix.
+         */
+        PackedGeneratingMatrix upperLeftSubMatrix(unsigned int nRows, unsigned int nCols) const;
+
+        /** Returns the submatrix with upper-left corner at position \c startingRow, \c startingCol
+         * with \c nRows rows and \c nCols columns.
+         * @param startingRow Row position of the upper-left corner.
+         * @param startingCol Column position of the upper-left corner.
+         * @param nRows Number of rows.
+         * @param nCols Number of columns.
+         * @return A copy of the submatrix.
+         */
+        PackedGeneratingMatrix subMatrix(unsigned int startingRow, unsigned int startingCol, unsigned int nRows, unsigned int nCols) const;
+
+        /**
+         * Computes the product of the matrix by matrix \c m.
+         * @param m Right multiplier.
+         */
+        PackedGeneratingMatrix operator*(const PackedGeneratingMatrix& m) const;
+
+        /** Swap the rows at position i1 and i2 of the matrix.
+         * @param i1 Position of the first row.
+         * @param i2 Position of the second row.
+         */
+        void swapRows(unsigned int i1, unsigned int i2);
+
+        /**
+         * Extends the matrix by stacking on the right the matrix \c block.
+         * @param block The matrix to stack. Should have the same number of rows as the base matrix.
+         */
+        void stackRight(const PackedGeneratingMatrix& block);
+
+        /**
+         * Extends the matrix by stacking below the matrix \c block.
+         * @param block The matrix to stack. Should have the same number of columns as the base matrix.
+         */
+        void stackBelow(const PackedGeneratingMatrix& block);
+
+        /** Overloads of << operator to print matrices. */
+        friend std::ostream& operator<<(std::ostream& os, const PackedGeneratingMatrix& mat);
+
+        std::string formatToColumnsReverse(unsigned int nBits = 31) const;
+
+        /** Returns an integer representation of the columns of the matrix. A column is read as a bit string
+         * with highest bit in first position.
+         */
+        std::vector<unsigned long> getColsReverse() const;
+
+        /** Creates a matrix from its reversed column representation.
+         * @param nInputRows Number of bits in the integer representation of the columns. Typically equals 31.
+         * @param nOutputRows Number of rows of the matrix returned by the function. Rows below are ignored. Typically equals the number of columns.
+         * @param columns Integer representation of the columns of the matrix.
+         */
+        static PackedGeneratingMatrix fromColsReverse(unsigned int nInputBits, unsigned int nOutputRows, const std::vector<unsigned long>& columns);
+
+    private:
+        std::vector<Word> m_data; // rows stored contiguously, m_nWords words per row
+        unsigned int m_nRows; // number of rows of the matrix
+        unsigned int m_nCols; // number of columns of the matrix
+        unsigned int m_nWords; // number of words per row
+};
+
+}
+#endif
@@ -48,6 +48,7 @@ struct CommandLine {
    std::string s_figureCombiner;
    std::string s_combiner;
    std::string s_verbose;
+   std::string s_shard;
    
    Real m_normType;
    Real m_weightPower;
@@ -57,6 +58,9 @@ struct CommandLine {
    std::unique_ptr<FigureOfMerit::FigureOfMerit> m_figure;
    int m_verbose;
    unsigned int m_interlacingFactor;
+   unsigned int m_numThreads = 1; // number of threads of the searches (0 for all the hardware threads)
+   unsigned int m_shard = 0; // index of the shard of the search space to explore
+   unsigned int m_numShards = 1; // number of shards of the search space
 
    std::unique_ptr<Task::Task> parse();
 };
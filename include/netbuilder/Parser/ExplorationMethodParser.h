@@ -23,10 +23,13 @@
 #include <boost/algorithm/string/join.hpp>
 #include <boost/algorithm/string/replace.hpp>
 #include <boost/lexical_cast.hpp>
+#include <algorithm>
 #include <fstream>
+#include <thread>
 
 #include "netbuilder/Types.h"
 #include "netbuilder/Parser/NetDescriptionParser.h"
+#include "netbuilder/Parser/FigureParser.h"
 
 #include "netbuilder/FigureOfMerit/FigureOfMerit.h"
 
@@ -111,46 +114,47 @@ struct ExplorationMethodParser
             return std::make_unique<Task::Eval>(std::move(net), std::move(commandLine.m_figure), commandLine.m_verbose);
         }
         else if (name == "exhaustive"){
-            return std::make_unique<Task::ExhaustiveSearch<NC, ET>>(commandLine.m_dimension,
+            auto search = std::make_unique<Task::ExhaustiveSearch<NC, ET>>(commandLine.m_dimension,
                                                         commandLine.m_sizeParameter,
                                                         std::move(commandLine.m_figure),
-                                                        commandLine.m_verbose);
+                                                        commandLine.m_verbose,
+                                                        true);
+            search->setShard(commandLine.m_shard, commandLine.m_numShards);
+            return withWorkerFigures(std::move(search), commandLine);
         }
-        else if (name == "random" || name == "random-CBC" || name == "mixed-CBC"){
+        if (commandLine.m_numShards > 1){
+            throw BadExplorationMethod("only exhaustive explorations can be sharded.");
+        }
+        if (name == "random" || name == "random-CBC" || name == "mixed-CBC"){
             if (explorationDescriptionStrings.size() < 2){
                 throw BadExplorationMethod("nb of random samples required; see --help");
             }
             r = boost::lexical_cast<unsigned int>(explorationDescriptionStrings[1]);
         }
-        if (name == "random")
-            return std::make_unique<Task::RandomSearch<NC, ET>>(commandLine.m_dimension,
+        if (name == "random"){
+            unsigned int samplesPerStream = 0;
+            if (explorationDescriptionStrings.size() >= 3){
+                samplesPerStream = boost::lexical_cast<unsigned int>(explorationDescriptionStrings[2]);
+            }
+            return withWorkerFigures(std::make_unique<Task::RandomSearch<NC, ET>>(commandLine.m_dimension,
                                                     commandLine.m_sizeParameter,
                                                     std::move(commandLine.m_figure),
                                                     r,
                                                     commandLine.m_verbose,
-                                                    true);
+                                                    true,
+                                                    samplesPerStream), commandLine);
+        }
 
 
-        std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure;
-        try{
-            auto pfigure = commandLine.m_figure.release();
-            figure = std::unique_ptr<FigureOfMerit::CBCFigureOfMerit>(dynamic_cast<FigureOfMerit::CBCFigureOfMerit*> (pfigure));
-            if (not(figure))
-            {
-                throw std::bad_cast();
-            }
-        } catch (std::bad_cast&)
-        {
-            throw BadExplorationMethod("the figure of merit cannot be used with CBC explorations.");
-        }
+        std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> figure = toCBCFigure(std::move(commandLine.m_figure));
             
         if (name == "random-CBC"){
-            return std::make_unique<Task::CBCSearch<NC, ET, Task::RandomCBCExplorer>>(commandLine.m_dimension, 
+            return withWorkerFigures(std::make_unique<Task::CBCSearch<NC, ET, Task::RandomCBCExplorer>>(commandLine.m_dimension, 
                                                             commandLine.m_sizeParameter,
                                                             std::move(figure),
                                                             std::make_unique<Task::RandomCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter, r),
                                                             commandLine.m_verbose,
-                                                            true);
+                                                            true), commandLine);
         }
 
         if (name == "mixed-CBC"){
@@ -159,20 +163,20 @@ struct ExplorationMethodParser
             }
             unsigned int nbFullCoordinates = boost::lexical_cast<unsigned int>(explorationDescriptionStrings[2]);
 
-            return std::make_unique<Task::CBCSearch<NC, ET, Task::MixedCBCExplorer>>(commandLine.m_dimension, 
+            return withWorkerFigures(std::make_unique<Task::CBCSearch<NC, ET, Task::MixedCBCExplorer>>(commandLine.m_dimension, 
                                                             commandLine.m_sizeParameter,
                                                             std::move(figure),
                                                             std::make_unique<Task::MixedCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter, nbFullCoordinates, r), 
                                                             commandLine.m_verbose,
-                                                            true);
+                                                            true), commandLine);
         }
         else if (name == "full-CBC"){
-            return std::make_unique<Task::CBCSearch<NC, ET,  Task::FullCBCExplorer>>(commandLine.m_dimension, 
+            return withWorkerFigures(std::make_unique<Task::CBCSearch<NC, ET,  Task::FullCBCExplorer>>(commandLine.m_dimension, 
                                                                 commandLine.m_sizeParameter,
                                                                 std::move(figure),
                                                                 std::make_unique<Task::FullCBCExplorer<NC, ET>>(commandLine.m_dimension, commandLine.m_sizeParameter),
                                                                 commandLine.m_verbose,
-                                                                true);
+                                                                true), commandLine);
         }
         else{
             throw BadExplorationMethod(name + " is not a valid exploration method; see --help");
@@ -180,6 +184,70 @@ struct ExplorationMethodParser
         return result_type();
     }
 
+    private:
+
+    /**
+     * Casts \c figure to a figure of merit which can be used with CBC explorations.
+     */
+    static std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> toCBCFigure(std::unique_ptr<FigureOfMerit::FigureOfMerit> figure)
+    {
+        std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> res;
+        try{
+            auto pfigure = figure.release();
+            res = std::unique_ptr<FigureOfMerit::CBCFigureOfMerit>(dynamic_cast<FigureOfMerit::CBCFigureOfMerit*> (pfigure));
+            if (not(res))
+            {
+                delete pfigure;
+                throw std::bad_cast();
+            }
+        } catch (std::bad_cast&)
+        {
+            throw BadExplorationMethod("the figure of merit cannot be used with CBC explorations.");
+        }
+        return res;
+    }
+
+    /**
+     * Returns the number of threads requested on the command line.
+     */
+    static unsigned int numThreads(const Parser::CommandLine<NC, ET>& commandLine)
+    {
+        if (commandLine.m_numThreads == 0)
+        {
+            return std::max(std::thread::hardware_concurrency(), 1u);
+        }
+        return commandLine.m_numThreads;
+    }
+
+    /**
+     * Gives to the search \c search one independent copy of the figure of merit per additional thread requested on the command line.
+     */
+    template <typename SEARCH>
+    static result_type withWorkerFigures(std::unique_ptr<SEARCH> search, Parser::CommandLine<NC, ET>& commandLine)
+    {
+        std::vector<std::unique_ptr<FigureOfMerit::FigureOfMerit>> workerFigures;
+        for (unsigned int i = 1; i < numThreads(commandLine); ++i)
+        {
+            workerFigures.push_back(FigureParser<NC, ET>::parse(commandLine));
+        }
+        search->setWorkerFigures(std::move(workerFigures));
+        return std::move(search);
+    }
+
+    /**
+     * Gives to the CBC search \c search one independent copy of the figure of merit per additional thread requested on the command line.
+     */
+    template <template <NetConstruction, EmbeddingType> class EXPLORER>
+    static result_type withWorkerFigures(std::unique_ptr<Task::CBCSearch<NC, ET, EXPLORER>> search, Parser::CommandLine<NC, ET>& commandLine)
+    {
+        std::vector<std::unique_ptr<FigureOfMerit::CBCFigureOfMerit>> workerFigures;
+        for (unsigned int i = 1; i < numThreads(commandLine); ++i)
+        {
+            workerFigures.push_back(toCBCFigure(FigureParser<NC, ET>::parse(commandLine)));
+        }
+        search->setWorkerFigures(std::move(workerFigures));
+        return std::move(search);
+    }
 
 };
 }
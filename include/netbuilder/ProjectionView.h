@@ -0,0 +1,127 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/**
+ * \file
+ * This file contains the definition of non-owning views on the generating matrices of a projection
+ */
+
+#ifndef NETBUILDER__PROJECTION_VIEW_H
+#define NETBUILDER__PROJECTION_VIEW_H
+
+#include "netbuilder/GeneratingMatrix.h"
+
+#include <boost/iterator/indirect_iterator.hpp>
+
+#include <cstddef>
+#include <vector>
+
+namespace NetBuilder {
+
+/** Non-owning view on a sequence of generating matrices, typically the generating matrices of the coordinates
+ * of a projection of a digital net.
+ *
+ * The view only holds a pointer to a contiguous array of pointers to the matrices and the size of this array,
+ * so that it is cheap to copy and never copies the matrices. The array of pointers and the matrices
+ * must outlive the view. Iterating over the view yields references to the matrices.
+ * Such arrays of pointers are obtained with AbstractDigitalNet::generatingMatrices() or ProjectionView::pointersTo().
+ */
+class ProjectionView {
+
+    public:
+
+        /// Type of the iterators over the matrices of the view.
+        typedef boost::indirect_iterator<const GeneratingMatrix* const*> const_iterator;
+
+        /// Type of the iterators over the matrices of the view.
+        typedef const_iterator iterator;
+
+        /** Constructs an empty view. */
+        ProjectionView():
+            m_data(nullptr),
+            m_size(0)
+        {}
+
+        /** Constructs a view on \c size matrices.
+         * @param data Pointer to the first element of an array of pointers to the matrices.
+         * @param size Number of matrices.
+         */
+        ProjectionView(const GeneratingMatrix* const* data, std::size_t size):
+            m_data(data),
+            m_size(size)
+        {}
+
+        /** Constructs a view on the matrices pointed to by the elements of \c matrices.
+         * @param matrices Pointers to the matrices.
+         */
+        ProjectionView(const std::vector<const GeneratingMatrix*>& matrices):
+            ProjectionView(matrices.data(), matrices.size())
+        {}
+
+        /** Deleted to prevent views on a temporary array of pointers, which would dangle. */
+        ProjectionView(std::vector<const GeneratingMatrix*>&&) = delete;
+
+        /** Returns the number of matrices in the view. */
+        std::size_t size() const { return m_size; }
+
+        /** Returns whether the view is empty. */
+        bool empty() const { return m_size == 0; }
+
+        /** Returns the matrix at position \c i of the view.
+         * @param i Position of the matrix.
+         */
+        const GeneratingMatrix& operator[](std::size_t i) const { return *m_data[i]; }
+
+        /** Returns the first matrix of the view. */
+        const GeneratingMatrix& front() const { return *m_data[0]; }
+
+        /** Returns the last matrix of the view. */
+        const GeneratingMatrix& back() const { return *m_data[m_size - 1]; }
+
+        /** Returns an iterator to the first matrix of the view. */
+        const_iterator begin() const { return const_iterator(m_data); }
+
+        /** Returns an iterator past the last matrix of the view. */
+        const_iterator end() const { return const_iterator(m_data + m_size); }
+
+        /** Returns the subview of the \c count matrices starting at position \c first.
+         * @param first Position of the first matrix of the subview.
+         * @param count Number of matrices of the subview.
+         */
+        ProjectionView subView(std::size_t first, std::size_t count) const { return ProjectionView(m_data + first, count); }
+
+        /** Returns pointers to the elements of \c matrices, which can be used to build a view on these matrices.
+         * @param matrices Matrices.
+         */
+        static std::vector<const GeneratingMatrix*> pointersTo(const std::vector<GeneratingMatrix>& matrices)
+        {
+            std::vector<const GeneratingMatrix*> res;
+            res.reserve(matrices.size());
+            for (const auto& mat : matrices)
+            {
+                res.push_back(&mat);
+            }
+            return res;
+        }
+
+    private:
+        const GeneratingMatrix* const* m_data; // pointer to the first pointer to a matrix
+        std::size_t m_size; // number of matrices
+};
+
+}
+
+#endif
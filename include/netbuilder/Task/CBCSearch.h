@@ -19,6 +19,12 @@
 
 #include "netbuilder/Task/Search.h"
 
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <vector>
+
 namespace NetBuilder { namespace Task {
 
 /** 
@@ -30,6 +36,10 @@ namespace NetBuilder { namespace Task {
  * - <CODE> typename NetConstructionTraits<NC>::GenValue nextGenValue() </CODE>: return the next generating value.
  * - <CODE> bool isOver() </CODE>: indicate whether the exploration of the current coordinate is over.
  * where NC is the template parameter of EXPLORER.
+ *
+ * When worker figures are given (see setWorkerFigures()), the candidates of each coordinate are evaluated concurrently,
+ * each worker thread using its own evaluator. The selected net does not depend on the number of threads: among
+ * the candidates with the minimal merit value, the first one provided by the explorer is selected.
  */ 
 template < NetConstruction NC, EmbeddingType ET, template <NetConstruction, EmbeddingType> class EXPLORER, template <NetConstruction> class OBSERVER = MinimumObserver>
 class CBCSearch : public Search<NC, ET, OBSERVER>
@@ -107,47 +117,78 @@ class CBCSearch : public Search<NC, ET, OBSERVER>
          */
         virtual void execute() override
         {
-
-            auto evaluator = this->m_figure->evaluator(); // create an evaluator
+            EvaluatorList evaluators;
+            evaluators.push_back(this->m_figure->evaluator()); // create an evaluator
+            for (auto& figure : m_workerFigures) // and one per additional worker thread
+            {
+                evaluators.push_back(figure->evaluator());
+            }
+            auto& evaluator = evaluators.front();
 
             // compute the merit of the base net is one was provided
             Real merit = 0; 
 
             for(Dimension coord = 0; coord < this->observer().bestNet().dimension(); ++coord)
             {
-                evaluator->prepareForNextDimension();
-                merit = (*evaluator)(this->observer().bestNet(), coord, merit) ;
-                evaluator->lastNetWasBest();
+                Real baseMerit = merit;
+                for (auto& eval : evaluators)
+                {
+                    eval->prepareForNextDimension();
+                    merit = (*eval)(this->observer().bestNet(), coord, baseMerit) ;
+                    eval->lastNetWasBest();
+                }
             }
 
+            std::atomic<Real> bound(std::numeric_limits<Real>::infinity()); // smallest merit value found by the worker threads for the current coordinate
+
             if (this->m_earlyAbortion) // if the switch is on, connect the abortion signals of the evaluator to the observer
             {
-                evaluator->onProgress().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onProgress, &this->observer(), boost::placeholders::_1));
-                evaluator->onAbort().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onAbort, &this->observer(), boost::placeholders::_1));
+                if (evaluators.size() == 1)
+                {
+                    evaluator->onProgress().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onProgress, &this->observer(), boost::placeholders::_1));
+                    evaluator->onAbort().connect(boost::bind(&Search<NC, ET, OBSERVER>::Observer::onAbort, &this->observer(), boost::placeholders::_1));
+                }
+                else // the observer is not thread-safe: the worker threads share an atomic bound instead
+                {
+                    for (auto& eval : evaluators)
+                    {
+                        eval->onProgress().connect([&bound] (Real partialMerit) { return partialMerit <= bound.load(); });
+                    }
+                }
             }
 
             m_explorer->switchToCoordinate(this->observer().bestNet().dimension()); // to to the first dimension to explore
 
             for(Dimension coord = this->observer().bestNet().dimension() ; coord < this->dimension(); ++coord) // for each dimension to explore
             {
-                evaluator->prepareForNextDimension();
+                for (auto& eval : evaluators)
+                {
+                    eval->prepareForNextDimension();
+                }
                 if(this->m_verbose>=1 && coord > 0)
                 {
                     std::cout << "Begin coordinate: " << coord + 1 << "/" << this->dimension() << std::endl;
                 }
-                auto net = this->m_observer->bestNet(); // base net of the search
-                while(!m_explorer->isOver()) // for each generating values provided by the explorer
+                if (evaluators.size() > 1)
                 {
-                    auto newNet = net.appendNewCoordinate(m_explorer->nextGenValue());
-                    unsigned long totalSize = m_explorer->size();
-                    if (this->m_verbose>=2 && ((totalSize > 100 && m_explorer->count() % 100 == 0) || (m_explorer->count() % 10 == 0)))
-                    {
-                        std::cout << "Coordinate " << coord + 1 << "/" << this->dimension() << " - net " << m_explorer->count() << "/" << totalSize << std::endl;
-                    }
-                    double newMerit = (*evaluator)(*newNet,coord,merit, this->m_verbose-3); // evaluate the net
-                    if (this->m_observer->observe(std::move(newNet),newMerit)) // give it to the observer
+                    exploreCoordinateInParallel(evaluators, coord, merit, bound);
+                }
+                else
+                {
+                    auto net = this->m_observer->bestNet(); // base net of the search
+                    while(!m_explorer->isOver()) // for each generating values provided by the explorer
                     {
-                        evaluator->lastNetWasBest();
+                        auto newNet = net.appendNewCoordinate(m_explorer->nextGenValue());
+                        unsigned long totalSize = m_explorer->size();
+                        if (this->m_verbose>=2 && ((totalSize > 100 && m_explorer->count() % 100 == 0) || (m_explorer->count() % 10 == 0)))
+                        {
+                            std::cout << "Coordinate " << coord + 1 << "/" << this->dimension() << " - net " << m_explorer->count() << "/" << totalSize << std::endl;
+                        }
+                        double newMerit = (*evaluator)(*newNet,coord,merit, this->m_verbose-3); // evaluate the net
+                        if (this->m_observer->observe(std::move(newNet),newMerit)) // give it to the observer
+                        {
+                            evaluator->lastNetWasBest();
+                        }
                     }
                 }
                 if (!this->m_observer->hasFoundNet())
@@ -193,11 +234,139 @@ class CBCSearch : public Search<NC, ET, OBSERVER>
             return *m_figure;
         }
 
+        /**
+         * Sets the figures of merit used by the additional worker threads. The search uses one thread per figure in
+         * \c workerFigures, in addition to the calling thread which uses the figure of the search. Each figure must
+         * describe the same figure of merit as the figure of the search, and must not share any mutable state with it
+         * or with the other figures, so that they can be evaluated concurrently.
+         * If \c workerFigures is empty, the search is sequential.
+         * @param workerFigures Figures of merit of the additional worker threads.
+         */
+        void setWorkerFigures(std::vector<std::unique_ptr<FigureOfMerit::CBCFigureOfMerit>> workerFigures)
+        {
+            m_workerFigures = std::move(workerFigures);
+        }
+
+        /**
+         * Returns the number of threads used to evaluate the candidates.
+         */
+        unsigned int numThreads() const { return (unsigned int) m_workerFigures.size() + 1; }
+
     private:
+        typedef std::vector<std::unique_ptr<FigureOfMerit::CBCFigureOfMeritEvaluator>> EvaluatorList;
+
+        static constexpr size_t CandidatesPerThread = 256; // number of candidates drawn from the explorer per thread and per batch
+
         std::unique_ptr<FigureOfMerit::CBCFigureOfMerit> m_figure;
         std::unique_ptr<Explorer> m_explorer;
+        std::vector<std::unique_ptr<FigureOfMerit::CBCFigureOfMerit>> m_workerFigures; // figures of the additional worker threads
+
+        /**
+         * Runs <CODE>func(i)</CODE> for each \c i smaller than \c numThreads, each call in its own thread except for
+         * <CODE>i = 0</CODE> which runs in the calling thread. Rethrows the first exception raised by a call, if any.
+         */
+        template <typename FUNC>
+        static void runInThreads(size_t numThreads, const FUNC& func)
+        {
+            std::vector<std::exception_ptr> errors(numThreads);
+            std::vector<std::thread> threads;
+            threads.reserve(numThreads - 1);
+            for (size_t i = 1; i < numThreads; ++i)
+            {
+                threads.emplace_back([&func, &errors, i] ()
+                {
+                    try { func(i); }
+                    catch (...) { errors[i] = std::current_exception(); }
+                });
+            }
+            try { func(0); }
+            catch (...) { errors[0] = std::current_exception(); }
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            for (const auto& error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+        /**
+         * Lowers the shared bound \c bound to \c merit if \c merit is smaller.
+         */
+        static void lowerBound(std::atomic<Real>& bound, Real merit)
+        {
+            Real current = bound.load();
+            while (merit < current && !bound.compare_exchange_weak(current, merit)) {}
+        }
+
+        /**
+         * Evaluates the candidates of coordinate \c coord with the evaluators \c evaluators in parallel and gives
+         * them to the observer in the order of the explorer.
+         * Candidates whose partial merit value exceeds \c bound, the smallest merit value found so far, are aborted
+         * if early abortion is on. Candidates which equal the bound are evaluated until the end so that ties are
+         * broken as in the sequential search.
+         */
+        void exploreCoordinateInParallel(EvaluatorList& evaluators, Dimension coord, Real merit, std::atomic<Real>& bound)
+        {
+            const auto net = this->m_observer->bestNet(); // base net of the search
+            bound = std::numeric_limits<Real>::infinity();
+            const size_t batchSize = CandidatesPerThread * evaluators.size();
+            std::vector<typename NetConstructionTraits<NC>::GenValue> genValues;
+            std::vector<std::unique_ptr<DigitalNet<NC>>> nets;
+            std::vector<Real> merits;
+            genValues.reserve(batchSize);
+            while(!m_explorer->isOver())
+            {
+                genValues.clear();
+                while(genValues.size() < batchSize && !m_explorer->isOver()) // draw the next candidates in the order of the explorer
+                {
+                    genValues.push_back(m_explorer->nextGenValue());
+                    unsigned long totalSize = m_explorer->size();
+                    if (this->m_verbose>=2 && ((totalSize > 100 && m_explorer->count() % 100 == 0) || (m_explorer->count() % 10 == 0)))
+                    {
+                        std::cout << "Coordinate " << coord + 1 << "/" << this->dimension() << " - net " << m_explorer->count() << "/" << totalSize << std::endl;
+                    }
+                }
+                nets.clear();
+                nets.resize(genValues.size());
+                merits.assign(genValues.size(), std::numeric_limits<Real>::infinity());
+                std::atomic<size_t> next(0);
+                runInThreads(evaluators.size(), [&] (size_t thread)
+                {
+                    auto& evaluator = *evaluators[thread];
+                    for (size_t i = next++; i < genValues.size(); i = next++)
+                    {
+                        nets[i] = net.appendNewCoordinate(genValues[i]);
+                        merits[i] = evaluator(*nets[i], coord, merit, this->m_verbose-3); // evaluate the net
+                        lowerBound(bound, merits[i]);
+                    }
+                });
+                for (size_t i = 0; i < nets.size(); ++i)
+                {
+                    this->m_observer->observe(std::move(nets[i]), merits[i]); // give the candidates to the observer in order
+                }
+            }
+            if (this->m_observer->hasFoundNet())
+            {
+                // bring every evaluator in the state corresponding to the selected net
+                bound = std::numeric_limits<Real>::infinity();
+                const auto& bestNet = this->m_observer->bestNet();
+                runInThreads(evaluators.size(), [&] (size_t thread)
+                {
+                    (*evaluators[thread])(bestNet, coord, merit);
+                    evaluators[thread]->lastNetWasBest();
+                });
+            }
+        }
 };
 
+template < NetConstruction NC, EmbeddingType ET, template <NetConstruction, EmbeddingType> class EXPLORER, template <NetConstruction> class OBSERVER>
+constexpr size_t CBCSearch<NC, ET, EXPLORER, OBSERVER>::CandidatesPerThread;
+
 }}
 
 
@@ -19,10 +19,33 @@
 
 #include "netbuilder/Task/Search.h"
 
+#include "latbuilder/SeqCombiner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
 namespace NetBuilder { namespace Task {
 
 /** 
  * Class for exhaustive search tasks.
+ *
+ * The search space is the Cartesian product of the spaces of generating values of the coordinates, whose elements
+ * are ranked in lexicographic order. The search can be restricted to a shard of this space (see setShard()), that is
+ * a contiguous range of ranks, so that independent processes can explore disjoint parts of the space. When worker figures
+ * are given (see setWorkerFigures()), the range is split into blocks which are evaluated concurrently. In both cases,
+ * among the nets with the minimal merit value, the net with the lowest rank is selected.
+ *
+ * If the figure of merit can be evaluated in a CBC way, the space is explored depth first: the nets which share their
+ * first generating values share the evaluation of the corresponding coordinates, so that only the coordinates which
+ * changed since the previous net are evaluated. If early abortion is on, the nets which start with a projection whose
+ * partial merit value is larger than the best merit value found so far are skipped altogether.
  */ 
 template < NetConstruction NC, EmbeddingType ET, template <NetConstruction> class OBSERVER = MinimumObserver>
 class ExhaustiveSearch : public Search<NC, ET, OBSERVER>
@@ -60,7 +83,12 @@ class ExhaustiveSearch : public Search<NC, ET, OBSERVER>
             std::string res;
             std::ostringstream stream;
             stream << Search<NC, ET, OBSERVER>::format();
-            stream << "Exploration method: exhaustive" << std::endl;
+            stream << "Exploration method: exhaustive";
+            if (m_numShards > 1)
+            {
+                stream << " - shard " << m_shard << "/" << m_numShards;
+            }
+            stream << std::endl;
             stream << "Figure of merit: " << m_figure->format() << std::endl;
             res += stream.str();
             stream.str(std::string());
@@ -73,6 +101,16 @@ class ExhaustiveSearch : public Search<NC, ET, OBSERVER>
         */
         virtual void execute() override 
         {
+            if (hasCBCFigures())
+            {
+                executeDepthFirst();
+                return;
+            }
+            if (!m_workerFigures.empty() || m_numShards > 1)
+            {
+                executeByBlocks();
+                return;
+            }
 
             auto evaluator = this->m_figure->evaluator();
 
@@ -113,10 +151,411 @@ class ExhaustiveSearch : public Search<NC, ET, OBSERVER>
             return *m_figure;
         }
 
+        /**
+         * Restricts the search to the shard \c shard out of \c numShards shards of equal sizes of the search space.
+         * The shards are contiguous ranges of ranks, in increasing order.
+         * @param shard Index of the shard, smaller than \c numShards.
+         * @param numShards Number of shards.
+         */
+        void setShard(unsigned int shard, unsigned int numShards)
+        {
+            if (numShards == 0 || shard >= numShards)
+            {
+                throw std::invalid_argument("the index of the shard must be smaller than the number of shards");
+            }
+            m_shard = shard;
+            m_numShards = numShards;
+        }
+
+        /**
+         * Sets the figures of merit used by the additional worker threads. The search uses one thread per figure in
+         * \c workerFigures, in addition to the calling thread which uses the figure of the search. Each figure must
+         * describe the same figure of merit as the figure of the search, and must not share any mutable state with it
+         * or with the other figures, so that they can be evaluated concurrently.
+         * @param workerFigures Figures of merit of the additional worker threads.
+         */
+        void setWorkerFigures(std::vector<std::unique_ptr<FigureOfMerit::FigureOfMerit>> workerFigures)
+        {
+            m_workerFigures = std::move(workerFigures);
+        }
+
+        /**
+         * Returns the number of threads used to evaluate the nets.
+         */
+        unsigned int numThreads() const { return (unsigned int) m_workerFigures.size() + 1; }
+
     private:
+        typedef typename NetConstructionTraits<NC>::GenValueSpaceCoordSeq GenValueSpaceCoordSeq;
+
+        static constexpr uInteger NetsPerBlock = 256; // minimal number of nets in the blocks taken by the threads
+
         std::unique_ptr<FigureOfMerit::FigureOfMerit> m_figure;
+        unsigned int m_shard = 0; // index of the shard of the search space to explore
+        unsigned int m_numShards = 1; // number of shards of the search space
+        std::vector<std::unique_ptr<FigureOfMerit::FigureOfMerit>> m_workerFigures; // figures of the additional worker threads
+
+        /**
+         * Best net found by a thread.
+         */
+        struct ThreadResult
+        {
+            Real merit = std::numeric_limits<Real>::infinity();
+            uInteger rank = 0;
+            std::unique_ptr<DigitalNet<NC>> net;
+        };
+
+        /**
+         * State of the depth-first exploration of a thread.
+         * The evaluator of coordinate \c k holds the state of the first \c k generating values of the current path,
+         * as if these values had been selected by a CBC search, provided that \c k is smaller than \c numValid.
+         */
+        struct DepthFirstState
+        {
+            std::vector<std::unique_ptr<FigureOfMerit::CBCFigureOfMeritEvaluator>> evaluators; // evaluator of each coordinate
+            std::vector<std::unique_ptr<DigitalNet<NC>>> nets; // net formed by the generating values of the path up to each coordinate
+            std::vector<Real> merits; // partial merit value of the net of each coordinate
+            std::vector<uInteger> digits; // index of the generating value of each coordinate on the path
+            std::vector<typename GenValueSpaceCoordSeq::const_iterator> values; // generating value of each coordinate on the path
+            Dimension numValid = 0; // number of evaluators in the state of the path
+            bool replaying = false; // whether an evaluator is being brought to the state of the path, which must not be aborted
+        };
+
+        /**
+         * Returns whether the figures of merit of the search and of the worker threads can be evaluated in a CBC way.
+         */
+        bool hasCBCFigures() const
+        {
+            if (!dynamic_cast<const FigureOfMerit::CBCFigureOfMerit*>(m_figure.get()))
+            {
+                return false;
+            }
+            for (const auto& figure : m_workerFigures)
+            {
+                if (!dynamic_cast<const FigureOfMerit::CBCFigureOfMerit*>(figure.get()))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Returns an iterator to the element of rank \c rank of the Cartesian product \c seq.
+         */
+        template <typename SEQ, template <typename> class INCREMENT>
+        static typename LatBuilder::SeqCombiner<SEQ, INCREMENT>::const_iterator iteratorAt(const LatBuilder::SeqCombiner<SEQ, INCREMENT>& seq, uInteger rank)
+        {
+            return seq.at(rank);
+        }
+
+        /**
+         * Returns an iterator to the element of rank \c rank of the sequence \c seq.
+         */
+        template <typename SEQ>
+        static auto iteratorAt(const SEQ& seq, uInteger rank) -> decltype(seq.begin())
+        {
+            auto it = seq.begin();
+            std::advance(it, rank);
+            return it;
+        }
+
+        /**
+         * Lowers the shared bound \c bound to \c merit if \c merit is smaller.
+         */
+        static void lowerBound(std::atomic<Real>& bound, Real merit)
+        {
+            Real current = bound.load();
+            while (merit < current && !bound.compare_exchange_weak(current, merit)) {}
+        }
+
+        /**
+         * Keeps the net \c net of rank \c rank in \c res if its merit value \c merit is smaller than the best one of the thread.
+         */
+        static void keep(ThreadResult& res, uInteger rank, std::unique_ptr<DigitalNet<NC>> net, Real merit, std::atomic<Real>& bound)
+        {
+            if (merit < res.merit) // the first best net of the thread is kept
+            {
+                res.merit = merit;
+                res.rank = rank;
+                res.net = std::move(net);
+                lowerBound(bound, merit);
+            }
+        }
+
+        /**
+         * Adds \c numNets to the number \c count of nets explored out of \c total and reports the progress.
+         */
+        void reportProgress(std::atomic<uInteger>& count, uInteger numNets, uInteger total) const
+        {
+            uInteger before = count.fetch_add(numNets);
+            if (this->m_verbose>0 && (before + numNets) / 10 != before / 10)
+            {
+                std::cout << "Net " << (before + numNets) / 10 * 10 << "/" << total << std::endl;
+            }
+        }
+
+        /**
+         * Returns the first rank and the past-the-end rank of the shard in a search space of \c size nets.
+         */
+        std::pair<uInteger, uInteger> shardRange(uInteger size) const
+        {
+            const uInteger first = m_shard * (size / m_numShards) + std::min<uInteger>(m_shard, size % m_numShards);
+            const uInteger last = first + size / m_numShards + (m_shard < size % m_numShards ? 1 : 0);
+            return std::make_pair(first, last);
+        }
+
+        /**
+         * Explores the ranks of \c range by blocks of consecutive ranks aligned on multiples of \c blockSize, using
+         * \c numThreads threads, and selects the best net. Thread \c i explores the ranks from \c begin to \c end
+         * by calling <CODE>explore(i, begin, end, result)</CODE>, which must keep its best net in \c result.
+         * The blocks are taken in increasing order by each thread.
+         */
+        template <typename EXPLORE>
+        void exploreByBlocks(std::pair<uInteger, uInteger> range, uInteger blockSize, unsigned int numThreads, const EXPLORE& explore)
+        {
+            const uInteger firstBlock = range.first / blockSize;
+            const uInteger numBlocks = (range.second + blockSize - 1) / blockSize - firstBlock;
+
+            std::atomic<uInteger> nextBlock(0);
+            std::vector<ThreadResult> results(numThreads);
+            std::vector<std::exception_ptr> errors(numThreads);
+            auto work = [&] (unsigned int thread)
+            {
+                try
+                {
+                    for (uInteger block = nextBlock++; block < numBlocks; block = nextBlock++)
+                    {
+                        const uInteger begin = std::max(range.first, (firstBlock + block) * blockSize);
+                        const uInteger end = std::min(range.second, (firstBlock + block + 1) * blockSize);
+                        explore(thread, begin, end, results[thread]);
+                    }
+                }
+                catch (...)
+                {
+                    errors[thread] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> threads;
+            for (unsigned int thread = 1; thread < numThreads; ++thread)
+            {
+                threads.emplace_back(work, thread);
+            }
+            work(0);
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            for (const auto& error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+
+            // give the best net of each thread to the observer, in the order of the ranks
+            std::sort(results.begin(), results.end(), [] (const ThreadResult& a, const ThreadResult& b) { return a.rank < b.rank; });
+            for (auto& result : results)
+            {
+                if (result.net)
+                {
+                    this->m_observer->observe(std::move(result.net), result.merit);
+                }
+            }
+            if (!this->m_observer->hasFoundNet())
+            {
+                this->onFailedSearch()(*this);
+                return;
+            }
+            this->selectBestNet(this->m_observer->bestNet(), this->m_observer->bestMerit());
+        }
+
+        /**
+         * Executes the search by blocks of consecutive ranks of the shard, possibly in parallel, evaluating each net from scratch.
+         */
+        void executeByBlocks()
+        {
+            const unsigned int numThreads = this->numThreads();
+            std::vector<std::unique_ptr<FigureOfMerit::FigureOfMeritEvaluator>> evaluators;
+            evaluators.push_back(this->m_figure->evaluator());
+            for (auto& figure : m_workerFigures)
+            {
+                evaluators.push_back(figure->evaluator());
+            }
+
+            std::atomic<Real> bound(std::numeric_limits<Real>::infinity()); // smallest merit value found by the threads
+            if (this->m_earlyAbortion) // nets equal to the bound are not aborted so that ties are broken as in the sequential search
+            {
+                for (auto& evaluator : evaluators)
+                {
+                    evaluator->onProgress().connect([&bound] (Real merit) { return merit <= bound.load(); });
+                }
+            }
+
+            const auto searchSpace = DigitalNet<NC>::ConstructionMethod::genValueSpace(this->dimension(), this->m_sizeParameter);
+            const auto range = shardRange(searchSpace.size());
+            std::atomic<uInteger> count(0); // number of nets explored by the threads
+
+            exploreByBlocks(range, NetsPerBlock, numThreads, [&] (unsigned int thread, uInteger begin, uInteger end, ThreadResult& res)
+            {
+                auto& evaluator = *evaluators[thread];
+                auto it = iteratorAt(searchSpace, begin);
+                for (uInteger rank = begin; rank < end; ++rank, ++it)
+                {
+                    reportProgress(count, 1, range.second - range.first);
+                    auto net = std::make_unique<DigitalNet<NC>>(this->m_dimension, this->m_sizeParameter, *it);
+                    Real merit = evaluator(*net, this->m_verbose-3);
+                    keep(res, rank, std::move(net), merit, bound);
+                }
+            });
+        }
+
+        /**
+         * Executes the search depth first with CBC evaluators, possibly in parallel.
+         * With a single thread, the shard is explored in a single block. Otherwise, the blocks are the smallest
+         * subtrees of the search space which contain at least NetsPerBlock nets.
+         */
+        void executeDepthFirst()
+        {
+            const unsigned int numThreads = this->numThreads();
+            const Dimension dimension = this->dimension();
+
+            std::vector<GenValueSpaceCoordSeq> seqs;
+            std::vector<uInteger> strides(dimension, 1); // number of nets in the subtrees rooted at each coordinate
+            for (Dimension coord = 0; coord < dimension; ++coord)
+            {
+                seqs.push_back(DigitalNet<NC>::ConstructionMethod::genValueSpaceCoord(coord, this->m_sizeParameter));
+            }
+            for (Dimension coord = dimension - 1; coord > 0; --coord)
+            {
+                strides[coord - 1] = strides[coord] * seqs[coord].size();
+            }
+            const uInteger size = strides[0] * seqs[0].size();
+            const auto range = shardRange(size);
+
+            uInteger blockSize = std::max<uInteger>(size, 1);
+            if (numThreads > 1)
+            {
+                for (Dimension coord = dimension; coord > 0; --coord)
+                {
+                    if (strides[coord - 1] >= NetsPerBlock)
+                    {
+                        blockSize = strides[coord - 1];
+                        break;
+                    }
+                }
+            }
+
+            std::atomic<Real> bound(std::numeric_limits<Real>::infinity()); // smallest merit value found by the threads
+            std::vector<DepthFirstState> states(numThreads);
+            for (unsigned int thread = 0; thread < numThreads; ++thread)
+            {
+                auto& figure = dynamic_cast<FigureOfMerit::CBCFigureOfMerit&>(thread == 0 ? *m_figure : *m_workerFigures[thread - 1]);
+                auto& state = states[thread];
+                for (Dimension coord = 0; coord < dimension; ++coord)
+                {
+                    state.evaluators.push_back(figure.evaluator());
+                    if (this->m_earlyAbortion) // nets equal to the bound are not aborted so that ties are broken as in the sequential search
+                    {
+                        state.evaluators.back()->onProgress().connect([&bound, &state] (Real merit) { return state.replaying || merit <= bound.load(); });
+                    }
+                }
+                state.nets.resize(dimension);
+                state.merits.resize(dimension);
+                state.digits.resize(dimension);
+                for (const auto& seq : seqs)
+                {
+                    state.values.push_back(seq.begin());
+                }
+            }
+
+            const DigitalNet<NC> emptyNet(0, this->m_sizeParameter);
+            std::atomic<uInteger> count(0); // number of nets explored by the threads
+
+            exploreByBlocks(range, blockSize, numThreads, [&] (unsigned int thread, uInteger begin, uInteger end, ThreadResult& res)
+            {
+                auto& state = states[thread];
+                for (Dimension coord = 0; coord < dimension; ++coord)
+                {
+                    state.digits[coord] = (begin / strides[coord]) % seqs[coord].size();
+                    state.values[coord] = iteratorAt(seqs[coord], state.digits[coord]);
+                }
+                state.numValid = 0;
+
+                Dimension depth = 0; // first coordinate of the path which changed
+                uInteger rank = begin;
+                while (rank < end)
+                {
+                    Dimension coord = depth;
+                    for (; coord < dimension; ++coord)
+                    {
+                        if (coord >= state.numValid)
+                        {
+                            bringToPath(state, coord);
+                        }
+                        state.nets[coord] = (coord == 0 ? emptyNet : *state.nets[coord - 1]).appendNewCoordinate(*state.values[coord]);
+                        state.merits[coord] = (*state.evaluators[coord])(*state.nets[coord], coord, coord == 0 ? 0 : state.merits[coord - 1], this->m_verbose-3);
+                        if (coord + 1 < dimension && this->m_earlyAbortion && state.merits[coord] > bound.load())
+                        {
+                            break; // the partial merit values do not decrease with the dimension: skip the subtree
+                        }
+                    }
+                    if (coord == dimension)
+                    {
+                        --coord;
+                        keep(res, rank, std::move(state.nets[coord]), state.merits[coord], bound);
+                    }
+
+                    // go to the next subtree rooted at coordinate coord
+                    const uInteger next = std::min(end, (rank / strides[coord] + 1) * strides[coord]);
+                    reportProgress(count, next - rank, range.second - range.first);
+                    rank = next;
+                    if (rank == end)
+                    {
+                        break;
+                    }
+                    depth = coord;
+                    ++state.digits[depth];
+                    ++state.values[depth];
+                    while (state.digits[depth] == seqs[depth].size())
+                    {
+                        --depth;
+                        ++state.digits[depth];
+                        ++state.values[depth];
+                    }
+                    for (Dimension j = depth + 1; j < dimension; ++j)
+                    {
+                        state.digits[j] = 0;
+                        state.values[j] = seqs[j].begin();
+                    }
+                    state.numValid = std::min<Dimension>(state.numValid, depth + 1);
+                }
+            });
+        }
+
+        /**
+         * Brings the evaluator of coordinate \c coord of \c state to the state of the first \c coord generating values of the path.
+         */
+        void bringToPath(DepthFirstState& state, Dimension coord) const
+        {
+            auto& evaluator = *state.evaluators[coord];
+            state.replaying = true;
+            evaluator.reset();
+            for (Dimension j = 0; j < coord; ++j)
+            {
+                evaluator.prepareForNextDimension();
+                evaluator(*state.nets[j], j, j == 0 ? 0 : state.merits[j - 1]);
+                evaluator.lastNetWasBest();
+            }
+            evaluator.prepareForNextDimension();
+            state.replaying = false;
+            state.numValid = coord + 1;
+        }
 };
 
+template < NetConstruction NC, EmbeddingType ET, template <NetConstruction> class OBSERVER>
+constexpr uInteger ExhaustiveSearch<NC, ET, OBSERVER>::NetsPerBlock;
+
 }}
 
 
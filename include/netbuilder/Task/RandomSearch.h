@@ -20,9 +20,24 @@
 #include "netbuilder/Task/Search.h"
 #include "latbuilder/LFSR258.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <limits>
+#include <thread>
+#include <vector>
+
 namespace NetBuilder { namespace Task {
 
-/** Class for CBC Search tasks.
+/** Class for random search tasks.
+ *
+ * When worker figures are given (see setWorkerFigures()), the samples are evaluated concurrently. The samples are
+ * split into consecutive streams of samplesPerStream() samples, the \f$c\f$-th stream being drawn from the random
+ * generator jumped \f$c\f$ times ahead (see LatBuilder::LFSR258::jump()). Each thread draws its own streams with its
+ * own generator, so that the selected net only depends on the length of the streams: among the samples with
+ * the minimal merit value, the first one is selected.
+ * By default, there is one stream per thread. Setting the length of the streams makes the search reproducible
+ * independently of the number of threads.
  */ 
 template < NetConstruction NC, EmbeddingType ET, template <NetConstruction> class OBSERVER = MinimumObserver>
 class RandomSearch : public Search<NC, ET, OBSERVER>
@@ -38,16 +53,19 @@ class RandomSearch : public Search<NC, ET, OBSERVER>
          * @param figure Figure of merit used to compare nets.
          * @param verbose Verbosity level.
          * @param earlyAbortion Early-abortion switch. If true, the computations will be stopped if the net is worse than the best one so far.
+         * @param samplesPerStream Number of samples drawn from each stream of the random generator. If \c 0, there is one stream per thread.
          */
         RandomSearch(   Dimension dimension, 
                         typename NetConstructionTraits<NC>::SizeParameter sizeParameter,
                         std::unique_ptr<FigureOfMerit::FigureOfMerit> figure,
                         unsigned nbTries,
                         int verbose = 0,
-                        bool earlyAbortion = false):
+                        bool earlyAbortion = false,
+                        unsigned int samplesPerStream = 0):
             Search<NC, ET, OBSERVER>(dimension, sizeParameter, verbose, earlyAbortion),
             m_figure(std::move(figure)),
             m_nbTries(nbTries),
+            m_samplesPerStream(samplesPerStream),
             m_randomGenValueGenerator(this->m_sizeParameter)
         {};
     
@@ -66,7 +84,12 @@ class RandomSearch : public Search<NC, ET, OBSERVER>
             std::string res;
             std::ostringstream stream;
             stream << Search<NC, ET, OBSERVER>::format();
-            stream << "Exploration method: random - " << m_nbTries << " samples" << std::endl;
+            stream << "Exploration method: random - " << m_nbTries << " samples";
+            if (m_samplesPerStream > 0)
+            {
+                stream << " - " << m_samplesPerStream << " samples per stream";
+            }
+            stream << std::endl;
             stream << "Figure of merit: " << m_figure->format() << std::endl;
             res += stream.str();
             stream.str(std::string());
@@ -88,6 +111,11 @@ class RandomSearch : public Search<NC, ET, OBSERVER>
         */
         virtual void execute() override 
         {
+            if (!m_workerFigures.empty() || m_samplesPerStream > 0)
+            {
+                executeStreams();
+                return;
+            }
 
             auto evaluator = this->m_figure->evaluator();
 
@@ -131,10 +159,199 @@ class RandomSearch : public Search<NC, ET, OBSERVER>
             return *m_figure;
         }
 
+        /**
+         * Sets the seed of the random generator.
+         * @param seed Seed of the random generator.
+         */
+        void setSeed(LatBuilder::LFSR258::seed_type seed)
+        {
+            m_randomGenValueGenerator.randomGenerator().seed(std::move(seed));
+        }
+
+        /**
+         * Sets the figures of merit used by the additional worker threads. The search uses one thread per figure in
+         * \c workerFigures, in addition to the calling thread which uses the figure of the search. Each figure must
+         * describe the same figure of merit as the figure of the search, and must not share any mutable state with it
+         * or with the other figures, so that they can be evaluated concurrently.
+         * @param workerFigures Figures of merit of the additional worker threads.
+         */
+        void setWorkerFigures(std::vector<std::unique_ptr<FigureOfMerit::FigureOfMerit>> workerFigures)
+        {
+            m_workerFigures = std::move(workerFigures);
+        }
+
+        /**
+         * Returns the number of threads used to evaluate the samples.
+         */
+        unsigned int numThreads() const { return (unsigned int) m_workerFigures.size() + 1; }
+
+        /**
+         * Returns the number of samples drawn from each stream of the random generator.
+         */
+        unsigned int samplesPerStream() const
+        {
+            if (m_samplesPerStream > 0)
+            {
+                return m_samplesPerStream;
+            }
+            return std::max((m_nbTries + numThreads() - 1) / numThreads(), 1u);
+        }
+
     private:
+        typedef typename ConstructionMethod:: template RandomGenValueGenerator <ET> RandomGenValueGenerator;
+
         std::unique_ptr<FigureOfMerit::FigureOfMerit> m_figure;
         unsigned int m_nbTries;
-        typename ConstructionMethod:: template RandomGenValueGenerator <ET> m_randomGenValueGenerator;
+        unsigned int m_samplesPerStream; // number of samples per stream of the random generator (0 for one stream per thread)
+        RandomGenValueGenerator m_randomGenValueGenerator;
+        std::vector<std::unique_ptr<FigureOfMerit::FigureOfMerit>> m_workerFigures; // figures of the additional worker threads
+
+        /**
+         * Best sample found by a thread.
+         */
+        struct ThreadResult
+        {
+            Real merit = std::numeric_limits<Real>::infinity();
+            unsigned int sample = 0;
+            std::unique_ptr<DigitalNet<NC>> net;
+        };
+
+        /**
+         * Draws and evaluates the samples of the streams \c thread, <CODE>thread + numThreads</CODE>, ...
+         * @param evaluator Evaluator of the thread.
+         * @param generator Random generator of generating values of the thread.
+         * @param firstStream State of the random generator at the beginning of the first stream.
+         * @param thread Index of the thread.
+         * @param numThreads Number of threads.
+         * @param bound Smallest merit value found by the threads so far.
+         * @param count Number of samples evaluated by the threads so far.
+         */
+        ThreadResult exploreStreams(FigureOfMerit::FigureOfMeritEvaluator& evaluator, RandomGenValueGenerator& generator, LatBuilder::LFSR258 firstStream,
+                                    unsigned int thread, unsigned int numThreads, std::atomic<Real>& bound, std::atomic<unsigned int>& count)
+        {
+            ThreadResult res;
+            const unsigned int streamLength = samplesPerStream();
+            const unsigned int numStreams = (m_nbTries + streamLength - 1) / streamLength;
+            LatBuilder::LFSR258 streamStart = firstStream;
+            for (unsigned int i = 0; i < thread; ++i)
+            {
+                streamStart.jump();
+            }
+            for (unsigned int stream = thread; stream < numStreams; stream += numThreads)
+            {
+                generator.randomGenerator() = streamStart;
+                const unsigned int end = std::min(m_nbTries, (stream + 1) * streamLength);
+                for (unsigned int sample = stream * streamLength; sample < end; ++sample)
+                {
+                    unsigned int attempt = ++count;
+                    if(this->m_verbose>0 && ((m_nbTries > 100 && attempt % 100 == 0) || (attempt % 10 == 0)))
+                    {
+                        std::cout << "Net " << attempt << "/" << m_nbTries << std::endl;
+                    }
+                    std::vector<typename ConstructionMethod::GenValue> genVals;
+                    genVals.reserve(this->dimension());
+                    for(Dimension dim = 0; dim < this->dimension(); ++dim)
+                    {
+                        genVals.push_back(generator(dim));
+                    }
+                    auto net = std::make_unique<DigitalNet<NC>>(this->m_dimension, this->m_sizeParameter, std::move(genVals));
+                    Real merit = evaluator(*net,this->m_verbose-3);
+                    if (merit < res.merit) // samples are drawn in increasing order: the first best sample is kept
+                    {
+                        res.merit = merit;
+                        res.sample = sample;
+                        res.net = std::move(net);
+                        Real current = bound.load();
+                        while (merit < current && !bound.compare_exchange_weak(current, merit)) {}
+                    }
+                }
+                for (unsigned int i = 0; i < numThreads; ++i)
+                {
+                    streamStart.jump();
+                }
+            }
+            return res;
+        }
+
+        /**
+         * Executes the search by streams of samples, possibly in parallel.
+         */
+        void executeStreams()
+        {
+            const unsigned int numThreads = this->numThreads();
+            std::vector<std::unique_ptr<FigureOfMerit::FigureOfMeritEvaluator>> evaluators;
+            evaluators.push_back(this->m_figure->evaluator());
+            for (auto& figure : m_workerFigures)
+            {
+                evaluators.push_back(figure->evaluator());
+            }
+
+            std::atomic<Real> bound(std::numeric_limits<Real>::infinity()); // smallest merit value found by the threads
+            std::atomic<unsigned int> count(0); // number of samples evaluated by the threads
+            if (this->m_earlyAbortion) // samples equal to the bound are not aborted so that ties are broken as in the sequential search
+            {
+                for (auto& evaluator : evaluators)
+                {
+                    evaluator->onProgress().connect([&bound] (Real merit) { return merit <= bound.load(); });
+                }
+            }
+
+            const LatBuilder::LFSR258 firstStream = m_randomGenValueGenerator.randomGenerator();
+            std::vector<ThreadResult> results(numThreads);
+            std::vector<std::exception_ptr> errors(numThreads);
+            auto work = [&] (unsigned int thread)
+            {
+                try
+                {
+                    RandomGenValueGenerator generator = m_randomGenValueGenerator;
+                    results[thread] = exploreStreams(*evaluators[thread], generator, firstStream, thread, numThreads, bound, count);
+                }
+                catch (...)
+                {
+                    errors[thread] = std::current_exception();
+                }
+            };
+            std::vector<std::thread> threads;
+            for (unsigned int thread = 1; thread < numThreads; ++thread)
+            {
+                threads.emplace_back(work, thread);
+            }
+            work(0);
+            for (auto& thread : threads)
+            {
+                thread.join();
+            }
+            for (const auto& error : errors)
+            {
+                if (error)
+                {
+                    std::rethrow_exception(error);
+                }
+            }
+
+            // the next execution starts after the streams of this one
+            const unsigned int numStreams = (m_nbTries + samplesPerStream() - 1) / samplesPerStream();
+            for (unsigned int i = 0; i < numStreams; ++i)
+            {
+                m_randomGenValueGenerator.randomGenerator().jump();
+            }
+
+            // give the best sample of each thread to the observer, in the order of the samples
+            std::sort(results.begin(), results.end(), [] (const ThreadResult& a, const ThreadResult& b) { return a.sample < b.sample; });
+            for (auto& result : results)
+            {
+                if (result.net)
+                {
+                    this->m_observer->observe(std::move(result.net), result.merit);
+                }
+            }
+            if (!this->m_observer->hasFoundNet())
+            {
+                this->onFailedSearch()(*this);
+                return;
+            }
+            this->selectBestNet(this->m_observer->bestNet(), this->m_observer->bestMerit());
+        }
 };
 
 }}
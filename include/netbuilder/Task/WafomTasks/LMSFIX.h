@@ -104,10 +104,9 @@ namespace NetBuilder
                      genVals.reserve(this->dimension());
                     for (Dimension dim = 0; dim < m_baseNet->dimension(); ++dim)
                     {
-                        auto C = m_baseNet->generatingMatrix(dim);
+                        const GeneratingMatrix &C = m_baseNet->generatingMatrix(dim);
                         auto L = (GeneratingMatrix::createRandomLowerTriangularMatrix(w, w, rng));
-                        auto C_tilde = (L * C); 
-                        genVals.push_back(std::move(C_tilde));
+                        genVals.push_back(L * C);
                     }
                    
                     auto net = std::make_unique<DigitalNet<NC>>(this->m_dimension, this->m_sizeParameter, std::move(genVals));
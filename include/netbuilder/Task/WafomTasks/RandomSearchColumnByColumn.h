@@ -5,6 +5,10 @@
 #include "latbuilder/LFSR258.h"
 #include "netbuilder/GeneratingMatrix.h"
 #include "netbuilder/Helpers/RankComputer.h"
+#include "netbuilder/PackedGeneratingMatrix.h"
+#include "netbuilder/FigureOfMerit/Wafom/FastWafom.h"
+#include <bitset>
+#include <cstdint>
 #include <limits>
 
 /**
@@ -36,6 +40,9 @@ namespace NetBuilder
             using SizeParameter = typename ConstructionMethod::SizeParameter;
 
         public:
+            /// Number of candidate columns evaluated in a single sweep over the points when the figure of merit is a FastWafom.
+            static constexpr unsigned int CandidatesPerBatch = 8;
+
             /** Constructor.
              * @param dimension Dimension of the searched net.
              * @param sizeParameter Size parameter of the searched net.
@@ -106,14 +113,15 @@ namespace NetBuilder
             /**
              * Executes the search task.
              * The best net and merit value are set in the process.
+             * If the figure of merit is a FastWafom, the candidates are evaluated with FigureOfMerit::FastWafom::ColumnEvaluator,
+             * which only computes the terms of the points added by the new column.
              */
             virtual void execute() override
             {
                 LatBuilder::LFSR258 rng;
 
                 auto evaluator = this->m_figure->evaluator();
-                // compute the merit of the base net is one was provided
-                Real merit = 0;
+                auto fastWafom = dynamic_cast<const FigureOfMerit::FastWafom *>(m_figure.get());
 
                 if (this->m_earlyAbortion)
                 {
@@ -122,28 +130,43 @@ namespace NetBuilder
                 }
                 auto Oldnet = this->m_observer->bestNet();
 
-                std::vector<GenValue> genVals, genVals_try;
+                const unsigned int nRows = this->nRows();
+
+                // generating matrices of the accepted net, extended by the column of the last candidate
+                std::vector<GenValue> genVals;
                 genVals.reserve(this->dimension());
 
                 unsigned int startColIndex;
-               
-                // When we get a baseNet we need to store the generating matrices 
+
+                // When we get a baseNet we need to store the generating matrices
                 if (this->nCols() != m_sizeParameter.second)
                 {
                     for (Dimension dim = 0; dim < this->dimension(); ++dim)
                     {
-                        GenValue genMat = Oldnet.generatingMatrix(dim);
-                        genVals.push_back(std::move(genMat));
+                        genVals.push_back(Oldnet.generatingMatrix(dim));
                     }
-                    // genVals_try = genVals;
                     startColIndex = this->nCols();
                 }
                 else
                 {
+                    genVals.assign(this->dimension(), GenValue(nRows, 0));
                     startColIndex = 0;
                 }
 
-                
+                std::unique_ptr<FigureOfMerit::FastWafom::ColumnEvaluator> columnEvaluator;
+                if (fastWafom)
+                {
+                    columnEvaluator = fastWafom->columnEvaluator(genVals);
+                }
+
+                // the candidates are generated and evaluated in batches, in a single sweep over the points for the column evaluator
+                const unsigned int batchSize = columnEvaluator ? CandidatesPerBatch : 1;
+                std::vector<std::vector<GenValue>> candidateCols(batchSize, std::vector<GenValue>(this->dimension()));
+                std::vector<std::vector<uInteger>> candidateColsReverse;
+                std::vector<GenValue> bestCols(this->dimension());
+                std::vector<uint64_t> schurRows(this->dimension());
+                std::vector<bool> hasSchurRow(this->dimension());
+
                 for (unsigned int colIndex = startColIndex + 1; colIndex <= m_sizeParameter.second; colIndex++)
                 {
 
@@ -154,70 +177,108 @@ namespace NetBuilder
                         std::cout << "Column  " << colIndex << "/" << m_sizeParameter.second << std::endl;
                     }
 
-                    for (unsigned int attempt = 1; attempt <= m_nbTries; ++attempt)
+                    for (Dimension dim = 0; dim < this->dimension(); ++dim)
                     {
-                        if (this->m_verbose > 0 && ((m_nbTries > 100 && attempt % 100 == 0) || (attempt % 10 == 0)))
-                        {
-                            std::cout << "Net " << attempt << "/" << m_nbTries << std::endl;
-                        }
+                        hasSchurRow[dim] = computeSchurRow(genVals[dim], colIndex - 1, schurRows[dim]);
+                        genVals[dim].resize(nRows, colIndex);
+                    }
 
-                        std::vector<GenValue> tmp_genVals = genVals;
+                    for (unsigned int firstAttempt = 1; firstAttempt <= m_nbTries; firstAttempt += batchSize)
+                    {
+                        const unsigned int numCandidates = std::min(batchSize, m_nbTries - firstAttempt + 1);
+                        candidateColsReverse.assign(numCandidates, std::vector<uInteger>(this->dimension()));
 
-                        RankComputer rankComputer(colIndex);
-                        for (Dimension dim = 0; dim < this->dimension(); ++dim)
+                        for (unsigned int b = 0; b < numCandidates; ++b)
                         {
-
-                            if (colIndex == 1)
+                            const unsigned int attempt = firstAttempt + b;
+                            if (this->m_verbose > 0 && ((m_nbTries > 100 && attempt % 100 == 0) || (attempt % 10 == 0)))
                             {
-                                GenValue col = GeneratingMatrix::createColumnMatrix(this->nRows(), colIndex, rng); // New column
+                                std::cout << "Net " << attempt << "/" << m_nbTries << std::endl;
+                            }
 
-                                GenValue subMat = col.upperLeftSubMatrix(colIndex, colIndex);
+                            for (Dimension dim = 0; dim < this->dimension(); ++dim)
+                            {
+                                GenValue &col = candidateCols[b][dim];
+                                col = GeneratingMatrix::createColumnMatrix(nRows, colIndex, rng); // New column
 
-                                if (col(0, 0) == 0)
+                                // make the upper left colIndex x colIndex submatrix invertible
+                                bool invertible;
+                                if (hasSchurRow[dim])
                                 {
-                                    subMat.flip(0, 0);
-                                    col.flip(0, 0);
+                                    uint64_t upperPart = 0;
+                                    for (unsigned int i = 0; i + 1 < colIndex; ++i)
+                                    {
+                                        upperPart |= uint64_t(col(i, 0)) << i;
+                                    }
+                                    invertible = bool(col(colIndex - 1, 0)) != bool(std::bitset<64>(schurRows[dim] & upperPart).count() % 2);
                                 }
-
-                                tmp_genVals.push_back(std::move(col));
-                            }
-                            else
-                            {
-                                GenValue col = GeneratingMatrix::createColumnMatrix(this->nRows(), colIndex, rng); // New column
-                                tmp_genVals[dim].stackRight(std::move(col));
-
-                                if (rankComputer.checkIfInvertible(tmp_genVals[dim].upperLeftSubMatrix(colIndex, colIndex)) == 0)
+                                else
                                 {
-                                    tmp_genVals[dim].flip(colIndex - 1, colIndex - 1);
+                                    setColumn(genVals[dim], colIndex - 1, col);
+                                    invertible = RankComputer::checkIfInvertible(genVals[dim].upperLeftSubMatrix(colIndex, colIndex));
                                 }
+                                if (!invertible)
+                                {
+                                    col.flip(colIndex - 1, 0);
+                                }
+                                candidateColsReverse[b][dim] = col.getColsReverse()[0];
                             }
                         }
 
-                        
-                        SizeParameter sizee(this->nRows(), colIndex);
-                        auto net = std::make_unique<DigitalNet<NC>>(this->m_dimension, sizee, tmp_genVals);
-
-                        double merit = (*evaluator)(*net, this->m_verbose - 3);
+                        std::vector<MeritValue> merits;
+                        if (columnEvaluator)
+                        {
+                            merits = (*columnEvaluator)(candidateColsReverse);
+                        }
 
-                        if (merit < lastmerit)
+                        for (unsigned int b = 0; b < numCandidates; ++b)
                         {
-                            lastmerit = merit;
-                            genVals_try = std::move(tmp_genVals);
-                            if (colIndex == m_sizeParameter.second)
+                            const unsigned int attempt = firstAttempt + b;
+                            std::unique_ptr<DigitalNet<NC>> net;
+                            double merit;
+                            if (columnEvaluator)
                             {
-                                this->m_observer->observe(std::move(net), merit);
+                                merit = merits[b];
+                            }
+                            else
+                            {
+                                net = makeNet(genVals, candidateCols[b], colIndex);
+                                merit = (*evaluator)(*net, this->m_verbose - 3);
                             }
-                        }
-                        if ((this->m_verbose > 0))
-                        {
 
-                            std::cout << "Net " << attempt << "/" << m_nbTries << " merit " << merit << std::endl;
+                            if (merit < lastmerit || attempt == 1)
+                            {
+                                lastmerit = merit;
+                                std::swap(bestCols, candidateCols[b]);
+                                if (columnEvaluator)
+                                {
+                                    columnEvaluator->lastNetWasBest(b);
+                                }
+                                if (colIndex == m_sizeParameter.second)
+                                {
+                                    if (!net)
+                                    {
+                                        net = makeNet(genVals, bestCols, colIndex);
+                                    }
+                                    this->m_observer->observe(std::move(net), merit);
+                                }
+                            }
+                            if ((this->m_verbose > 0))
+                            {
+
+                                std::cout << "Net " << attempt << "/" << m_nbTries << " merit " << merit << std::endl;
+                            }
                         }
                     }
 
-                    // rankComputers = std::move(rankComputers_try);
-                    // rng.jump();
-                    genVals = std::move(genVals_try);
+                    for (Dimension dim = 0; dim < this->dimension(); ++dim)
+                    {
+                        setColumn(genVals[dim], colIndex - 1, bestCols[dim]);
+                    }
+                    if (columnEvaluator)
+                    {
+                        columnEvaluator->prepareForNextColumn();
+                    }
                 }
 
                 if (!this->m_observer->hasFoundNet())
@@ -241,6 +302,85 @@ namespace NetBuilder
             std::unique_ptr<FigureOfMerit::FigureOfMerit> m_figure;
             unsigned int m_nbTries;
             SizeParameter m_sizeParameter;
+
+            /**
+             * Copies \c column into the column of index \c colIndex of \c matrix.
+             */
+            static void setColumn(GenValue &matrix, unsigned int colIndex, const GenValue &column)
+            {
+                for (unsigned int i = 0; i < matrix.nRows(); ++i)
+                {
+                    matrix(i, colIndex) = column(i, 0);
+                }
+            }
+
+            /**
+             * Returns the net whose generating matrices are \c genVals with their last column replaced by \c cols.
+             */
+            std::unique_ptr<DigitalNet<NC>> makeNet(std::vector<GenValue> &genVals, const std::vector<GenValue> &cols, unsigned int colIndex) const
+            {
+                for (Dimension dim = 0; dim < this->dimension(); ++dim)
+                {
+                    setColumn(genVals[dim], colIndex - 1, cols[dim]);
+                }
+                return std::make_unique<DigitalNet<NC>>(this->m_dimension, SizeParameter(this->nRows(), colIndex), genVals);
+            }
+
+            /**
+             * Computes the row \f$y = v A^{-1}\f$, where \f$A\f$ is the upper left \c n x \c n submatrix of \c matrix and
+             * \f$v\f$ is made of the first \c n elements of row \c n of \c matrix.
+             * Since the upper left <CODE>(n + 1) x (n + 1)</CODE> submatrix is \f$\begin{pmatrix} A & u \\ v & b \end{pmatrix}\f$,
+             * it is invertible if and only if \f$b \neq y u\f$, so that a new column can be checked with a single parity.
+             * The element \c i of \f$y\f$ is the bit \c i of \c res.
+             * Returns false if \f$A\f$ is singular, in which case \c res is not set.
+             */
+            static bool computeSchurRow(const GenValue &matrix, unsigned int n, uint64_t &res)
+            {
+                if (n >= 64 || n >= matrix.nRows())
+                {
+                    return false;
+                }
+                // row-reduced rows of A, with their pivots and the combinations of the rows of A which give them
+                std::vector<uint64_t> reduced, combinations;
+                std::vector<unsigned int> pivots;
+                auto rowOf = [&matrix, n](unsigned int i)
+                {
+                    uint64_t row = 0;
+                    for (unsigned int j = 0; j < n; ++j)
+                    {
+                        row |= uint64_t(matrix(i, j)) << j;
+                    }
+                    return row;
+                };
+                auto reduce = [&](uint64_t &row, uint64_t &combination)
+                {
+                    for (size_t k = 0; k < pivots.size(); ++k)
+                    {
+                        if ((row >> pivots[k]) & 1)
+                        {
+                            row ^= reduced[k];
+                            combination ^= combinations[k];
+                        }
+                    }
+                };
+                for (unsigned int i = 0; i < n; ++i)
+                {
+                    uint64_t row = rowOf(i);
+                    uint64_t combination = uint64_t(1) << i;
+                    reduce(row, combination);
+                    if (row == 0)
+                    {
+                        return false;
+                    }
+                    reduced.push_back(row);
+                    combinations.push_back(combination);
+                    pivots.push_back(PackedGeneratingMatrix::countTrailingZeros(row));
+                }
+                uint64_t row = rowOf(n);
+                res = 0;
+                reduce(row, res);
+                return true;
+            }
         };
 
     }
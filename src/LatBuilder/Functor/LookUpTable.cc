@@ -0,0 +1,90 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/Functor/LookUpTable.h"
+
+// Function multiversioning requires GCC 6 or later and ifunc support from the C library.
+#if defined(__x86_64__) && defined(__GLIBC__) && defined(__GNUC__) && __GNUC__ >= 6 && !defined(__clang__)
+#define LATBUILDER_LOOKUP_TABLE_AVX2
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// multiplies products[p] by the table values of the segments of points[p * stride], for p in [begin, end)
+inline void multiplyFactorsScalar(const uint64_t *points, std::size_t begin, std::size_t end, std::size_t stride, double *products,
+                                  int segments, const double *table, const int *shifts, const uint64_t *masks, const uint64_t *offsets)
+{
+    for (std::size_t p = begin; p < end; ++p)
+    {
+        const uint64_t x = points[p * stride];
+        double prod = products[p];
+        for (int c = 0; c < segments; ++c)
+        {
+            prod *= table[offsets[c] + ((x >> shifts[c]) & masks[c])];
+        }
+        products[p] = prod;
+    }
+}
+
+#ifdef LATBUILDER_LOOKUP_TABLE_AVX2
+
+__attribute__((target("default")))
+void multiplyFactorsKernel(const uint64_t *points, std::size_t numPoints, std::size_t stride, double *products,
+                           int segments, const double *table, const int *shifts, const uint64_t *masks, const uint64_t *offsets)
+{
+    multiplyFactorsScalar(points, 0, numPoints, stride, products, segments, table, shifts, masks, offsets);
+}
+
+// four points at once, with gathers from the tables
+__attribute__((target("avx2")))
+void multiplyFactorsKernel(const uint64_t *points, std::size_t numPoints, std::size_t stride, double *products,
+                           int segments, const double *table, const int *shifts, const uint64_t *masks, const uint64_t *offsets)
+{
+    std::size_t p = 0;
+    for (; p + 4 <= numPoints; p += 4)
+    {
+        const __m256i x = _mm256_set_epi64x((long long)points[(p + 3) * stride], (long long)points[(p + 2) * stride],
+                                            (long long)points[(p + 1) * stride], (long long)points[p * stride]);
+        __m256d prod = _mm256_loadu_pd(products + p);
+        for (int c = 0; c < segments; ++c)
+        {
+            const __m256i e = _mm256_and_si256(_mm256_srli_epi64(x, shifts[c]), _mm256_set1_epi64x((long long)masks[c]));
+            const __m256i idx = _mm256_add_epi64(e, _mm256_set1_epi64x((long long)offsets[c]));
+            prod = _mm256_mul_pd(prod, _mm256_i64gather_pd(table, idx, 8));
+        }
+        _mm256_storeu_pd(products + p, prod);
+    }
+    multiplyFactorsScalar(points, p, numPoints, stride, products, segments, table, shifts, masks, offsets);
+}
+
+#else
+
+void multiplyFactorsKernel(const uint64_t *points, std::size_t numPoints, std::size_t stride, double *products,
+                           int segments, const double *table, const int *shifts, const uint64_t *masks, const uint64_t *offsets)
+{
+    multiplyFactorsScalar(points, 0, numPoints, stride, products, segments, table, shifts, masks, offsets);
+}
+
+#endif
+
+}
+
+void LookUpTable::multiplyFactors(const uint64_t *points, std::size_t numPoints, std::size_t stride, double *products) const
+{
+    multiplyFactorsKernel(points, numPoints, stride, products, numSegments(), lookupTable.data(),
+                          shifts.data(), masks.data(), offsets.data());
+}
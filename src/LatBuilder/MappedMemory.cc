@@ -0,0 +1,189 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/MappedMemory.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_set>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LATBUILDER_MAPPED_FILES
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace LatBuilder {
+
+constexpr size_t MappedMemory::Unlimited;
+
+namespace {
+   std::mutex mutex;
+
+   // maximal total size of the blocks allocated in RAM
+   size_t ramBudget = MappedMemory::Unlimited;
+
+   // directory of the memory-mapped files, empty meaning the default one
+   std::string mappedDirectory;
+
+   size_t resident = 0;
+   size_t mapped = 0;
+
+   // blocks mapped to files
+   std::unordered_set<void*> mappedBlocks;
+
+#ifdef LATBUILDER_MAPPED_FILES
+   [[noreturn]] void mappingError(const std::string& what, const std::string& path)
+   {
+      throw std::runtime_error("MappedMemory: cannot " + what + " " + path + ": " + std::strerror(errno));
+   }
+
+   void* mapFile(size_t bytes, const std::string& directory)
+   {
+      std::string path = directory + "/latnetbuilder-state-XXXXXX";
+      std::vector<char> name(path.begin(), path.end());
+      name.push_back('\0');
+
+      const int fd = mkstemp(name.data());
+      if (fd < 0)
+         mappingError("create a file in", directory);
+      // the file is removed when it is unmapped
+      unlink(name.data());
+
+#if defined(__linux__)
+      const int res = posix_fallocate(fd, 0, static_cast<off_t>(bytes));
+      if (res != 0) {
+         close(fd);
+         errno = res;
+         mappingError("reserve disk space in", directory);
+      }
+#else
+      if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+         close(fd);
+         mappingError("resize a file in", directory);
+      }
+#endif
+
+      void* block = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      close(fd);
+      if (block == MAP_FAILED)
+         mappingError("map a file in", directory);
+      madvise(block, bytes, MADV_SEQUENTIAL);
+      return block;
+   }
+#endif
+}
+
+void MappedMemory::setBudget(size_t bytes)
+{
+   std::lock_guard<std::mutex> lock(mutex);
+   ramBudget = bytes;
+}
+
+size_t MappedMemory::budget()
+{
+   std::lock_guard<std::mutex> lock(mutex);
+   return ramBudget;
+}
+
+void MappedMemory::setDirectory(std::string directory)
+{
+   std::lock_guard<std::mutex> lock(mutex);
+   mappedDirectory = std::move(directory);
+}
+
+std::string MappedMemory::directory()
+{
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (!mappedDirectory.empty())
+         return mappedDirectory;
+   }
+   const char* tmpdir = std::getenv("TMPDIR");
+   return tmpdir && *tmpdir ? tmpdir : "/tmp";
+}
+
+size_t MappedMemory::residentSize()
+{
+   std::lock_guard<std::mutex> lock(mutex);
+   return resident;
+}
+
+size_t MappedMemory::mappedSize()
+{
+   std::lock_guard<std::mutex> lock(mutex);
+   return mapped;
+}
+
+void* MappedMemory::allocate(size_t bytes)
+{
+   bool inRam = true;
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+#ifdef LATBUILDER_MAPPED_FILES
+      inRam = bytes == 0 || ramBudget == Unlimited || resident + bytes <= ramBudget;
+#endif
+      if (inRam)
+         resident += bytes;
+   }
+
+   if (inRam) {
+      try {
+         return ::operator new(bytes);
+      }
+      catch (...) {
+         std::lock_guard<std::mutex> lock(mutex);
+         resident -= bytes;
+         throw;
+      }
+   }
+
+#ifdef LATBUILDER_MAPPED_FILES
+   void* block = mapFile(bytes, directory());
+   std::lock_guard<std::mutex> lock(mutex);
+   mapped += bytes;
+   mappedBlocks.insert(block);
+   return block;
+#else
+   throw std::bad_alloc();
+#endif
+}
+
+void MappedMemory::deallocate(void* block, size_t bytes)
+{
+   {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (mappedBlocks.erase(block) == 0) {
+         resident -= bytes;
+      }
+      else {
+         mapped -= bytes;
+#ifdef LATBUILDER_MAPPED_FILES
+         munmap(block, bytes);
+#endif
+         return;
+      }
+   }
+   ::operator delete(block);
+}
+
+}
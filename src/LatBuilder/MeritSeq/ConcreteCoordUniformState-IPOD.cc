@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include "latbuilder/MeritSeq/ConcreteCoordUniformState-IPOD.h"
+#include "latbuilder/MeritSeq/StateKernels.h"
 #include "latbuilder/TextStream.h"
 #include <iostream>
 
@@ -51,7 +52,7 @@ reset()\
    m_state.clear();\
    m_partialWeightedState.clear(); \
    m_elemPolySum.clear();\
-   m_state.push_back(RealVector(this->storage().size(), 1.0));\
+   m_state.push_back(StateVector(this->storage().size(), 1.0));\
    m_partialWeightedState = RealVector(this->storage().size(), m_weights.getWeightForOrder(1));\
    m_elemPolySum = RealVector(this->storage().size(), 1.); /*the first elementary symmetric polynomial equals 1*/\
 }\
@@ -78,18 +79,16 @@ update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen)
       const Real pweight = m_weights.getWeightForCoordinate(newCoordinate / m_interlacingFactor);\
 \
       \
-      m_state.push_back(RealVector(this->storage().size(), 0.0));\
+      m_state.push_back(StateVector(this->storage().size(), 0.0));\
 \
-      for (size_t order = m_state.size() - 1; order > 0; order--)\
-            m_state[order] += boost::numeric::ublas::element_prod(\
-                  pweight * m_elemPolySum,\
-                  m_state[order - 1]\
-                  );\
+      updateStateOrders(m_state, m_elemPolySum, pweight);\
 \
-      m_partialWeightedState = RealVector(this->storage().size(), 0.);\
+      std::vector<Real> weights(m_state.size());\
       for (size_t order = 0; order < m_state.size(); order++){\
-            m_partialWeightedState += m_weights.getWeightForOrder(order+1) * m_state[order];\
+            weights[order] = m_weights.getWeightForOrder(order+1);\
       }\
+      m_partialWeightedState.resize(this->storage().size(), false);\
+      weightedStateSum(m_state, weights, Real(1.0), m_partialWeightedState);\
       m_elemPolySum = RealVector(this->storage().size(), 1.);\
 \
    }\
@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include "latbuilder/MeritSeq/ConcreteCoordUniformState-OD.h"
+#include "latbuilder/MeritSeq/StateKernels.h"
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -28,9 +29,10 @@ ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::OrderDependentWe
 reset()
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::reset();
+   m_numOrders = numOrdersToKeep(m_weights);
    m_state.clear();
    // order 0
-   m_state.push_back(RealVector(this->storage().size(), 1.0));
+   m_state.push_back(StateVector(this->storage().size(), 1.0));
 }
 
 //===========================================================================
@@ -42,17 +44,15 @@ update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen)
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::update(kernelValues, gen);
 
-   auto stridedKernelValues = this->storage().strided(kernelValues, gen);
+   RealVector stridedKernelValues;
+   gatherStrided(this->storage().strided(kernelValues, gen), stridedKernelValues);
 
-   // add new order
-   m_state.push_back(RealVector(this->storage().size(), 0.0));
+   // add new order, unless all higher orders have zero weight
+   if (m_state.size() < m_numOrders)
+      m_state.push_back(StateVector(this->storage().size(), 0.0));
 
-   // recursive update by decreasing order to avoid unwanted overwriting
-   for (size_t order = m_state.size() - 1; order > 0; order--)
-      m_state[order] += boost::numeric::ublas::element_prod(
-            stridedKernelValues,
-            m_state[order - 1]
-            );
+   // recursive update by decreasing order, in a single pass over the vectors
+   updateStateOrders(m_state, stridedKernelValues, Real(1.0));
 }
 
 //===========================================================================
@@ -64,19 +64,12 @@ weightedState() const
 {
    using LatticeTester::Coordinates;
 
-   RealVector weightedState =
-      boost::numeric::ublas::scalar_vector<Real>(this->storage().size(), 0.0);
-
-   for (Coordinates::size_type order = 0; order < m_state.size(); order++) {
-
-      Real weight = m_weights.getWeightForOrder(order + 1);
-
-      if (weight == 0.0)
-         continue;
-
-      weightedState += weight * m_state[order];
-   }
+   std::vector<Real> weights(m_state.size());
+   for (Coordinates::size_type order = 0; order < m_state.size(); order++)
+      weights[order] = m_weights.getWeightForOrder(order + 1);
 
+   RealVector weightedState(this->storage().size());
+   weightedStateSum(m_state, weights, Real(1.0), weightedState);
    return weightedState;
 }
 
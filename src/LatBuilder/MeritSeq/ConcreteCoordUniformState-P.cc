@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include "latbuilder/MeritSeq/ConcreteCoordUniformState-P.h"
+#include "latbuilder/MeritSeq/StateKernels.h"
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -41,18 +42,14 @@ update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen)
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::update(kernelValues, gen);
 
-   auto stridedKernelValues = this->storage().strided(kernelValues, gen);
+   RealVector stridedKernelValues;
+   gatherStrided(this->storage().strided(kernelValues, gen), stridedKernelValues);
 
    const auto newCoordinate = this->dimension() - 1;
 
    const Real weight = m_weights.getWeightForCoordinate(newCoordinate);
 
-   const auto ones = boost::numeric::ublas::scalar_vector<Real>(this->storage().size(), 1.0);
-
-   m_state = boost::numeric::ublas::element_prod(
-         ones + weight * stridedKernelValues,
-         m_state
-         );
+   updateProductState(m_state, stridedKernelValues, weight);
 }
 
 //===========================================================================
@@ -66,7 +63,9 @@ weightedState() const
 
    const Real weight = m_weights.getWeightForCoordinate(nextCoordinate);
 
-   return weight * m_state;
+   RealVector weightedState(this->storage().size());
+   weightedStateSum(std::vector<const Real*>{m_state.data().begin()}, std::vector<Real>{weight}, Real(1.0), weightedState.data().begin(), weightedState.size());
+   return weightedState;
 }
 
 template class ConcreteCoordUniformState<LatticeType::ORDINARY, EmbeddingType::UNILEVEL, Compress::NONE, PerLevelOrder::BASIC,      LatticeTester::ProductWeights>;
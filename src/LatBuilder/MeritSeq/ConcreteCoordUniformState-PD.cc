@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include "latbuilder/MeritSeq/ConcreteCoordUniformState-PD.h"
+#include "latbuilder/MeritSeq/StateKernels.h"
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -38,7 +39,7 @@ reset()
 //===========================================================================
 
 template <LatticeType LR, EmbeddingType ET, Compress COMPRESS, PerLevelOrder PLO>
-const RealVector&
+const StateVector&
 ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::ProjectionDependentWeights>::
 createStateVector(const LatticeTester::Coordinates& projection, const RealVector& kernelValues)
 {
@@ -53,7 +54,7 @@ createStateVector(const LatticeTester::Coordinates& projection, const RealVector
    LatticeTester::Coordinates baseProjection = projection;
    baseProjection.erase(largestCoord);
    // create base state vector
-   const RealVector& baseState = createStateVector(baseProjection, kernelValues);
+   const StateVector& baseState = createStateVector(baseProjection, kernelValues);
 
    // compute merit value for new projection
    auto stridedKernelValues = this->storage().strided(
@@ -100,8 +101,8 @@ weightedState() const
 
    const auto nextCoordinate = this->dimension();
 
-   RealVector weightedState =
-      boost::numeric::ublas::scalar_vector<Real>(this->storage().size(), 0.0);
+   std::vector<const Real*> states;
+   std::vector<Real> weights;
 
    for (const auto& pw : m_weights.getWeightsForLargestIndex(nextCoordinate)) {
       // remove largest coordinate index
@@ -112,9 +113,12 @@ weightedState() const
       if (it == m_state.end())
          throw std::runtime_error("projection-dependent state was not created");
       // contribute to weighted state
-      weightedState += pw.second * it->second;
+      states.push_back(it->second.data().begin());
+      weights.push_back(pw.second);
    }
 
+   RealVector weightedState(this->storage().size());
+   weightedStateSum(states, weights, Real(1.0), weightedState.data().begin(), weightedState.size());
    return weightedState;
 }
 
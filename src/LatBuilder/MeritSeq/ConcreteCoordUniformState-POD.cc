@@ -15,6 +15,7 @@
 // limitations under the License.
 
 #include "latbuilder/MeritSeq/ConcreteCoordUniformState-POD.h"
+#include "latbuilder/MeritSeq/StateKernels.h"
 
 namespace LatBuilder { namespace MeritSeq {
 
@@ -28,9 +29,10 @@ ConcreteCoordUniformState<LR, ET, COMPRESS, PLO, LatticeTester::PODWeights>::
 reset()
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::reset();
+   m_numOrders = numOrdersToKeep(m_weights.getOrderDependentWeights());
    m_state.clear();
    // order 0
-   m_state.push_back(RealVector(this->storage().size(), 1.0));
+   m_state.push_back(StateVector(this->storage().size(), 1.0));
 }
 
 //===========================================================================
@@ -42,21 +44,19 @@ update(const RealVector& kernelValues, typename LatticeTraits<LR>::GenValue gen)
 {
    CoordUniformState<LR, ET, COMPRESS, PLO>::update(kernelValues, gen);
 
-   auto stridedKernelValues = this->storage().strided(kernelValues, gen);
+   RealVector stridedKernelValues;
+   gatherStrided(this->storage().strided(kernelValues, gen), stridedKernelValues);
 
    const auto newCoordinate = this->dimension() - 1;
 
    const Real pweight = m_weights.getProductWeights().getWeightForCoordinate(newCoordinate);
 
-   // add new order
-   m_state.push_back(RealVector(this->storage().size(), 0.0));
+   // add new order, unless all higher orders have zero weight
+   if (m_state.size() < m_numOrders)
+      m_state.push_back(StateVector(this->storage().size(), 0.0));
 
-   // recursive update by decreasing order to avoid unwanted overwriting
-   for (size_t order = m_state.size() - 1; order > 0; order--)
-      m_state[order] += boost::numeric::ublas::element_prod(
-            pweight * stridedKernelValues,
-            m_state[order - 1]
-            );
+   // recursive update by decreasing order, in a single pass over the vectors
+   updateStateOrders(m_state, stridedKernelValues, pweight);
 }
 
 //===========================================================================
@@ -72,20 +72,13 @@ weightedState() const
 
    const Real pweight = m_weights.getProductWeights().getWeightForCoordinate(nextCoordinate);
 
-   RealVector weightedState =
-      boost::numeric::ublas::scalar_vector<Real>(this->storage().size(), 0.0);
+   std::vector<Real> weights(m_state.size());
+   for (Coordinates::size_type order = 0; order < m_state.size(); order++)
+      weights[order] = m_weights.getOrderDependentWeights().getWeightForOrder(order + 1);
 
-   for (Coordinates::size_type order = 0; order < m_state.size(); order++) {
-
-      Real weight = m_weights.getOrderDependentWeights().getWeightForOrder(order + 1);
-
-      if (weight == 0.0)
-         continue;
-
-      weightedState += weight * m_state[order];
-   }
-
-   return pweight * weightedState;
+   RealVector weightedState(this->storage().size());
+   weightedStateSum(m_state, weights, pweight, weightedState);
+   return weightedState;
 }
 
 
@@ -0,0 +1,159 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+
+#include "latbuilder/MeritSeq/StateKernels.h"
+#include "latbuilder/Parallel.h"
+
+#include <algorithm>
+
+namespace LatBuilder { namespace MeritSeq {
+
+namespace {
+
+/*
+ * The kernels process the vectors by blocks of BlockSize elements, so that the
+ * blocks of all orders stay in cache while they are updated, and each block is
+ * processed NumLanes elements at a time with GCC vector extensions.
+ * With GCC on x86-64 Linux, the kernels are compiled for AVX-512, AVX2 and the
+ * baseline instruction set, and the best version is selected at runtime.
+ * The chunks of StateChunkSize elements are processed concurrently.
+ */
+constexpr size_t BlockSize = 2048;
+
+static_assert(StateChunkSize % BlockSize == 0, "the chunks must be made of whole blocks");
+
+#if defined(__GNUC__)
+
+#define LATBUILDER_STATE_VECTOR_KERNEL
+
+constexpr size_t NumLanes = 8;
+
+// Unaligned view of NumLanes consecutive elements.  The vectors are only accessed
+// through references, so that they are never passed by value across a function boundary.
+typedef Real RealLanes __attribute__((vector_size(NumLanes * sizeof(Real)), aligned(alignof(Real)), may_alias));
+
+inline __attribute__((always_inline)) RealLanes& lanes(Real* p)
+{ return *reinterpret_cast<RealLanes*>(p); }
+
+inline __attribute__((always_inline)) const RealLanes& lanes(const Real* p)
+{ return *reinterpret_cast<const RealLanes*>(p); }
+
+#endif
+
+// Products and sums are not contracted to FMA, so that all versions return the same results as the ublas expressions.
+// target_clones requires GCC 6 or later and ifunc support from the C library.
+#if defined(__x86_64__) && defined(__GLIBC__) && defined(__GNUC__) && __GNUC__ >= 6 && !defined(__clang__)
+#define LATBUILDER_STATE_TARGETS __attribute__((target_clones("avx512f", "avx2", "default"), optimize("fp-contract=off")))
+#else
+#define LATBUILDER_STATE_TARGETS
+#endif
+
+// out += factors * in, elementwise on [0, len)
+inline __attribute__((always_inline)) void multiplyAdd(Real* __restrict__ out, const Real* __restrict__ factors, const Real* __restrict__ in, size_t len)
+{
+   size_t i = 0;
+#ifdef LATBUILDER_STATE_VECTOR_KERNEL
+   for (; i + NumLanes <= len; i += NumLanes)
+      lanes(out + i) = lanes(out + i) + lanes(factors + i) * lanes(in + i);
+#endif
+   for (; i < len; i++)
+      out[i] += factors[i] * in[i];
+}
+
+LATBUILDER_STATE_TARGETS
+void updateBlocks(Real* const* state, size_t numOrders, const Real* factors, Real scale, size_t begin, size_t end)
+{
+   Real scaled[BlockSize];
+   for (; begin < end; begin += BlockSize) {
+      const size_t len = std::min(BlockSize, end - begin);
+      for (size_t i = 0; i < len; i++)
+         scaled[i] = scale * factors[begin + i];
+      // by decreasing order to avoid unwanted overwriting
+      for (size_t order = numOrders - 1; order > 0; order--)
+         multiplyAdd(state[order] + begin, scaled, state[order - 1] + begin, len);
+   }
+}
+
+LATBUILDER_STATE_TARGETS
+void updateProductBlocks(Real* state, const Real* factors, Real weight, size_t begin, size_t end)
+{
+   size_t i = begin;
+#ifdef LATBUILDER_STATE_VECTOR_KERNEL
+   for (; i + NumLanes <= end; i += NumLanes)
+      lanes(state + i) = (1.0 + weight * lanes(factors + i)) * lanes(state + i);
+#endif
+   for (; i < end; i++)
+      state[i] = (1.0 + weight * factors[i]) * state[i];
+}
+
+LATBUILDER_STATE_TARGETS
+void sumBlocks(const Real* const* state, const Real* weights, size_t numTerms, Real scale, Real* out, size_t begin, size_t end)
+{
+   for (; begin < end; begin += BlockSize) {
+      const size_t len = std::min(BlockSize, end - begin);
+      Real* block = out + begin;
+      std::fill(block, block + len, Real(0.0));
+      for (size_t term = 0; term < numTerms; term++) {
+         const Real weight = weights[term];
+         const Real* in = state[term] + begin;
+         size_t i = 0;
+#ifdef LATBUILDER_STATE_VECTOR_KERNEL
+         for (; i + NumLanes <= len; i += NumLanes)
+            lanes(block + i) = lanes(block + i) + weight * lanes(in + i);
+#endif
+         for (; i < len; i++)
+            block[i] += weight * in[i];
+      }
+      for (size_t i = 0; i < len; i++)
+         block[i] *= scale;
+   }
+}
+
+}
+
+void updateStateOrders(const std::vector<Real*>& state, const Real* factors, Real scale, size_t size)
+{
+   if (state.size() < 2)
+      return;
+   Parallel::forEachRange(size, StateChunkSize, [&](size_t begin, size_t end) {
+         updateBlocks(state.data(), state.size(), factors, scale, begin, end);
+         });
+}
+
+void updateProductState(Real* state, const Real* factors, Real weight, size_t size)
+{
+   Parallel::forEachRange(size, StateChunkSize, [&](size_t begin, size_t end) {
+         updateProductBlocks(state, factors, weight, begin, end);
+         });
+}
+
+void weightedStateSum(const std::vector<const Real*>& state, const std::vector<Real>& weights, Real scale, Real* out, size_t size)
+{
+   std::vector<const Real*> terms;
+   std::vector<Real> termWeights;
+   for (size_t order = 0; order < std::min(state.size(), weights.size()); order++) {
+      if (weights[order] == 0.0)
+         continue;
+      terms.push_back(state[order]);
+      termWeights.push_back(weights[order]);
+   }
+   Parallel::forEachRange(size, StateChunkSize, [&](size_t begin, size_t end) {
+         sumBlocks(terms.data(), termWeights.data(), terms.size(), scale, out, begin, end);
+         });
+}
+
+}}
@@ -0,0 +1,40 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "latbuilder/Parallel.h"
+
+namespace LatBuilder {
+
+namespace {
+   // maximal number of threads used by Parallel, 0 meaning all the hardware threads;
+   // the command-line tools raise it with --fft-threads or --merit-threads
+   std::atomic<unsigned int> maxNumThreads(1);
+}
+
+void Parallel::setNumThreads(unsigned int numThreads)
+{
+   maxNumThreads.store(numThreads);
+}
+
+unsigned int Parallel::numThreads()
+{
+   unsigned int numThreads = maxNumThreads.load();
+   if (numThreads == 0)
+      numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+   return numThreads;
+}
+
+}
@@ -19,6 +19,9 @@
 #include "latbuilder/Parser/CommandLine.h"   
 #include "latbuilder/TextStream.h"
 #include "latbuilder/Types.h"
+#include "latbuilder/fftw++.h"
+#include "latbuilder/MappedMemory.h"
+#include "latbuilder/Parallel.h"
 
 #include "netbuilder/DigitalNet.h"
 #include "netbuilder/Types.h"
@@ -168,7 +171,25 @@ makeOptionsDescription()
     ("output-style,O", po::value<std::string>()->default_value(""),
     "(optional) TBD")
    ("merit-digits-displayed", po::value<unsigned int>()->default_value(0),
-    "(optional) number of significant figures to use when displaying merit values\n");
+    "(optional) number of significant figures to use when displaying merit values\n")
+   ("fft-planner", po::value<std::string>()->default_value("estimate"),
+    "(optional) effort of the FFTW planner for the fast-CBC exploration; possible values:\n"
+    "  estimate (default)\n"
+    "  measure\n"
+    "  patient\n"
+    "The plans are created once for each transform size and reused.\n")
+   ("fft-threads", po::value<unsigned int>()->default_value(0),
+    "(optional) maximal number of threads used by the FFT's of the fast-CBC exploration and by the updates\n"
+    "of the coordinate-uniform states of the CBC explorations; 0 for all the hardware threads (default: 0)\n")
+   ("fft-wisdom", po::value<std::string>(),
+    "(optional) path to a file of FFTW wisdom; if the file exists, the wisdom is imported before the exploration, "
+    "and the wisdom of the planner is exported to the file after the exploration\n")
+   ("state-memory", po::value<unsigned long>(),
+    "(optional) memory budget, in MiB, for the state vectors of the coordinate-uniform CBC explorations; "
+    "the state vectors beyond the budget are kept in memory-mapped files (default: unlimited)\n")
+   ("state-directory", po::value<std::string>(),
+    "(optional) directory of the memory-mapped files of the state vectors beyond --state-memory "
+    "(default: $TMPDIR or /tmp); it should be on a local disk\n");
 
    return desc;
 }
@@ -428,6 +449,37 @@ int main(int argc, const char *argv[])
         // global variable
         merit_digits_displayed = opt["merit-digits-displayed"].as<unsigned int>();
 
+        const std::string fftPlanner = opt["fft-planner"].as<std::string>();
+        if (fftPlanner == "estimate")
+          fftw<Real>::set_planner_flags(FFTW_ESTIMATE);
+        else if (fftPlanner == "measure")
+          fftw<Real>::set_planner_flags(FFTW_MEASURE);
+        else if (fftPlanner == "patient")
+          fftw<Real>::set_planner_flags(FFTW_PATIENT);
+        else
+          throw std::runtime_error("--fft-planner must be one of estimate, measure or patient (try --help)");
+
+        // the levels are transformed, and the states updated, concurrently; only the largest transforms are also split among threads
+        LatBuilder::Parallel::setNumThreads(opt["fft-threads"].as<unsigned int>());
+        fftw<Real>::set_num_threads(static_cast<int>(LatBuilder::Parallel::numThreads()), size_t(1) << 20);
+
+        if (opt.count("state-memory") >= 1){
+          const unsigned long stateMemory = opt["state-memory"].as<unsigned long>();
+          if (stateMemory > (LatBuilder::MappedMemory::Unlimited >> 20))
+            throw std::runtime_error("--state-memory must not exceed " + std::to_string(LatBuilder::MappedMemory::Unlimited >> 20) + " MiB");
+          LatBuilder::MappedMemory::setBudget(size_t(stateMemory) << 20);
+        }
+        if (opt.count("state-directory") >= 1)
+          LatBuilder::MappedMemory::setDirectory(opt["state-directory"].as<std::string>());
+
+        std::string fftWisdom = "";
+        if (opt.count("fft-wisdom") >= 1){
+          fftWisdom = opt["fft-wisdom"].as<std::string>();
+          if (boost::filesystem::exists(fftWisdom) && !fftw<Real>::import_wisdom(fftWisdom)){
+            std::cerr << "WARNING: cannot import FFTW wisdom from " << fftWisdom << std::endl;
+          }
+        }
+
         std::string outputstyle = opt["output-style"].as<std::string>();
 
        LatBuilder::LatticeType lattice = Parser::LatticeParser::parse(opt["construction"].as<std::string>());
@@ -550,6 +602,10 @@ int main(int argc, const char *argv[])
                
              }
       }
+
+      if (fftWisdom != "" && !fftw<Real>::export_wisdom(fftWisdom)){
+        std::cerr << "WARNING: cannot export FFTW wisdom to " << fftWisdom << std::endl;
+      }
    }
    catch (Parser::ParserError& e) {
       std::cerr << "COMMAND LINE ERROR: " << e.what() << std::endl;
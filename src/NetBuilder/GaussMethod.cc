@@ -17,8 +17,13 @@
 #include <map>
 #include <fstream>
 #include <algorithm>
+#include <atomic>
+#include <limits>
+#include <mutex>
+#include <thread>
 
 #include "netbuilder/FigureOfMerit/TValueComputation.h"
+#include "netbuilder/PackedGeneratingMatrix.h"
 #include "netbuilder/Helpers/RankComputer.h"
 #include "netbuilder/Helpers/CompositionMaker.h"
 
@@ -26,54 +31,173 @@
 
 namespace NetBuilder {
 
-unsigned int iteration_on_k(std::vector<GeneratingMatrix>& baseMatrices, unsigned int k, int verbose){
-    unsigned int nCols = baseMatrices[0].nCols();
-    unsigned int s = (unsigned int) baseMatrices.size();
-    
-    // Initialization of row map from original matrices to computation matrix
-    std::map<std::pair<int, int>, int> Origin_to_M;
+namespace {
+
+    // minimal number of compositions in a range evaluated by a thread
+    constexpr unsigned long MinRangeLength = 1024;
 
-    RankComputer rankComputer(nCols);
+    // number of ranges per thread, to balance the load between the threads
+    constexpr unsigned int RangesPerThread = 4;
 
-    for (unsigned int i=0; i<k-s+1; i++){
-        Origin_to_M[{1, i+1}] = i;
-        rankComputer.addRow(baseMatrices[s-1].subMatrix(i, 0, 1, nCols));
+    // maximal number of threads used by GaussMethod, 0 meaning all the hardware threads
+    std::atomic<unsigned int> maxNumThreads(1);
+
+    // number of compositions of k in s parts, saturated to the maximal unsigned long
+    unsigned long numberOfCompositions(unsigned int k, unsigned int s)
+    {
+        unsigned long res = 1;
+        for (unsigned int i = 1; i < s; ++i)
+        {
+            // binomial(k-s+i, i) = binomial(k-s+i-1, i-1) * (k-s+i) / i, which is exact
+            unsigned long factor = k - s + i;
+            if (res > std::numeric_limits<unsigned long>::max() / factor)
+            {
+                return std::numeric_limits<unsigned long>::max();
+            }
+            res = res * factor / i;
+        }
+        return res;
     }
-    for (unsigned int i=1; i<s; i++){
-        Origin_to_M[{i+1, 1}] = k-s+i;
-        rankComputer.addRow(baseMatrices[s-1-i].subMatrix(0, 0, 1, nCols));
+
+    // Seeds the rank computer with the rows selected by the composition held by compositionMaker:
+    // the first comp[i-1] rows of matrix s-i, for each part i. The row j (1-based) of the i-th part (1-based) 
+    // is mapped to its position in the rank computer by originToM[(i-1) * (k+1) + j].
+    void seedRankComputer(const std::vector<PackedGeneratingMatrix>& baseMatrices, unsigned int k, const CompositionMaker& compositionMaker, RankComputer& rankComputer, std::vector<int>& originToM)
+    {
+        unsigned int s = (unsigned int) baseMatrices.size();
+        const std::vector<unsigned int>& comp = compositionMaker.currentComposition();
+        originToM.resize(s * (k + 1));
+        rankComputer.reset(baseMatrices[0].nCols());
+
+        int row = 0;
+        for (unsigned int part = 1; part <= s; part++){
+            for (unsigned int j = 1; j <= comp[part-1]; j++){
+                originToM[(part - 1) * (k + 1) + j] = row++;
+                rankComputer.addRow(baseMatrices[s-part], j-1);
+            }
+        }
     }
 
-    unsigned int smallestFullRankIndex = rankComputer.smallestFullRank() - 1;
+    // Evaluates the compositions of k in s parts starting at the current composition of compositionMaker.
+    // At most nCompositions compositions are evaluated, and the evaluation stops as soon as a rank deficiency
+    // is found or cancel is set. Returns the smallest number of columns minus one such that all the systems are of full rank,
+    // or the number of columns if a system is not of full rank.
+    unsigned int iterationOnRange(const std::vector<PackedGeneratingMatrix>& baseMatrices, unsigned int k, CompositionMaker& compositionMaker, unsigned long nCompositions, RankComputer& rankComputer, std::vector<int>& originToM, const std::atomic<bool>& cancel, int verbose)
+    {
+        unsigned int nCols = baseMatrices[0].nCols();
+        unsigned int s = (unsigned int) baseMatrices.size();
+        auto originIndex = [k](const std::pair<int, int>& origin) { return (origin.first - 1) * (k + 1) + origin.second; };
 
-    if (smallestFullRankIndex == nCols){
-        return nCols;
+        seedRankComputer(baseMatrices, k, compositionMaker, rankComputer, originToM);
+
+        unsigned int smallestFullRankIndex = rankComputer.smallestFullRank() - 1;
+
+        if (smallestFullRankIndex == nCols){
+            return nCols;
+        }
+
+        for (unsigned long n = 1; n < nCompositions && compositionMaker.goToNextComposition(); n++) {
+
+            if (cancel.load(std::memory_order_relaxed)){
+                break;
+            }
+
+            const std::pair<std::pair<int, int>, std::pair<int, int>>& rowChange = compositionMaker.changeFromPreviousComposition();
+
+            int ind_exchange = originToM[originIndex(rowChange.first)];
+            originToM[originIndex(rowChange.second)] = ind_exchange;
+
+            rankComputer.replaceRow(ind_exchange, baseMatrices[s-rowChange.second.first], rowChange.second.second-1, verbose-1);
+
+            smallestFullRankIndex = rankComputer.smallestFullRank() - 1;
+
+            if (smallestFullRankIndex == nCols){
+                return smallestFullRankIndex;
+            }
+        }
+        return smallestFullRankIndex;
     }
 
-    CompositionMaker compositionMaker(k, s);
+    unsigned int numThreadsToUse()
+    {
+        unsigned int numThreads = maxNumThreads.load();
+        if (numThreads == 0)
+        {
+            numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+        }
+        return numThreads;
+    }
+}
+
+unsigned int iteration_on_k(const std::vector<PackedGeneratingMatrix>& baseMatrices, unsigned int k, RankComputer& rankComputer, std::vector<int>& originToM, int verbose){
+    unsigned int nCols = baseMatrices[0].nCols();
+    unsigned int nRows = baseMatrices[0].nRows();
+    unsigned int s = (unsigned int) baseMatrices.size();
 
-    while (compositionMaker.goToNextComposition()) {
+    const unsigned long nCompositions = numberOfCompositions(k, s);
+    const unsigned int numThreads = (unsigned int) std::min<unsigned long>(numThreadsToUse(), nCompositions / MinRangeLength);
 
-        std::pair<std::pair<int, int>, std::pair<int, int>> rowChange = compositionMaker.changeFromPreviousComposition();
+    std::atomic<bool> cancel(false);
 
-        int ind_exchange = Origin_to_M[rowChange.first];
-        Origin_to_M[rowChange.second] = ind_exchange;
-        Origin_to_M.erase(rowChange.first);
-        
-        GeneratingMatrix newRow = baseMatrices[s-rowChange.second.first].subMatrix(rowChange.second.second-1, 0, 1, nCols);
+    if (numThreads <= 1){
+        CompositionMaker compositionMaker(k, s);
+        return iterationOnRange(baseMatrices, k, compositionMaker, nCompositions, rankComputer, originToM, cancel, verbose);
+    }
 
-        rankComputer.replaceRow(ind_exchange, std::move(newRow), verbose-1);
+    // Splits the sequence of compositions into contiguous ranges. The rank computer of each range is seeded with the first
+    // composition of the range. Since the pivots of the seeded rank computer are those of the matrix of the composition,
+    // the smallest full rank of each range only depends on the compositions of the range, and the maximum over all the ranges
+    // is the result of the sequential iteration.
+    // The beginnings of the ranges are obtained by a shared composition maker, advanced by the threads when they take a new range,
+    // so that the enumeration stops early when a rank deficiency is found.
+    const unsigned long rangeLength = std::max(MinRangeLength, nCompositions / ((unsigned long) numThreads * RangesPerThread));
 
-        smallestFullRankIndex = rankComputer.smallestFullRank() - 1;
+    std::mutex cursorMutex;
+    CompositionMaker cursor(k, s);
+    bool depleted = false;
+    unsigned int result = 0;
 
-        if (smallestFullRankIndex == nCols){
-            return smallestFullRankIndex;
+    auto worker = [&](RankComputer& workerRankComputer, std::vector<int>& workerOriginToM){
+        CompositionMaker rangeBeginning(k, s);
+        while (true){
+            {
+                std::lock_guard<std::mutex> lock(cursorMutex);
+                if (depleted || cancel.load()){
+                    return;
+                }
+                rangeBeginning = cursor;
+                for (unsigned long n = 0; n < rangeLength && !depleted; n++){
+                    depleted = !cursor.goToNextComposition();
+                }
+            }
+            unsigned int rangeResult = iterationOnRange(baseMatrices, k, rangeBeginning, rangeLength, workerRankComputer, workerOriginToM, cancel, verbose);
+            if (rangeResult == nCols){
+                cancel.store(true);
+            }
+            std::lock_guard<std::mutex> lock(cursorMutex);
+            result = std::max(result, rangeResult);
         }
+    };
+
+    std::vector<std::thread> threads;
+    std::vector<RankComputer> rankComputers(numThreads - 1);
+    std::vector<std::vector<int>> originToMs(numThreads - 1);
+    for (unsigned int t = 0; t < numThreads - 1; t++){
+        rankComputers[t].reserve(nRows, nCols);
+        threads.emplace_back(worker, std::ref(rankComputers[t]), std::ref(originToMs[t]));
+    }
+    worker(rankComputer, originToM);
+    for (auto& thread : threads){
+        thread.join();
     }
-    return smallestFullRankIndex;
+
+    if (cancel.load()){
+        return nCols;
+    }
+    return result;
 }
 
-unsigned int GaussMethod::computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int maxSubProj, int verbose=0)
+unsigned int GaussMethod::computeTValue(ProjectionView baseMatrices, unsigned int maxSubProj, int verbose=0)
 {
     unsigned int s = (unsigned int) baseMatrices.size();
     if (s == 1)
@@ -84,18 +208,35 @@ unsigned int GaussMethod::computeTValue(std::vector<GeneratingMatrix> baseMatric
     return GaussMethod::computeTValue(baseMatrices, baseMatrices[0].nCols()-1, {maxSubProj}, verbose)[0];
 }
 
-std::vector<unsigned int> GaussMethod::computeTValue(std::vector<GeneratingMatrix> baseMatrices, unsigned int mMin, const std::vector<unsigned int>& maxSubProj, int verbose=0)
+void GaussMethod::setNumThreads(unsigned int numThreads)
+{
+    maxNumThreads.store(numThreads);
+}
+
+unsigned int GaussMethod::numThreads()
+{
+    return numThreadsToUse();
+}
+
+std::vector<unsigned int> GaussMethod::computeTValue(ProjectionView baseMatrices, unsigned int mMin, const std::vector<unsigned int>& maxSubProj, int verbose=0)
 {
     unsigned int nRows = baseMatrices[0].nRows();
     unsigned int nCols = baseMatrices[0].nCols();
     unsigned int s = (unsigned int) baseMatrices.size();
 
     unsigned int nLevel = (unsigned int) maxSubProj.size();
+
+    std::vector<PackedGeneratingMatrix> packedMatrices;
+    packedMatrices.reserve(s);
+    for (const auto& mat : baseMatrices){
+        packedMatrices.emplace_back(mat);
+    }
     
     if (s == 1){
         RankComputer rankComputer(nCols);
+        rankComputer.reserve(nRows, nCols);
         for (unsigned int r=0; r<nRows; r++){
-            rankComputer.addRow(baseMatrices[0].subMatrix(r, 0, 1, nCols));
+            rankComputer.addRow(packedMatrices[0], r);
         }
         std::map<unsigned int, unsigned int> pivotPos = rankComputer.getPivots();
         
@@ -133,8 +274,12 @@ std::vector<unsigned int> GaussMethod::computeTValue(std::vector<GeneratingMatri
     unsigned int previousIndSmallestInvertible = nLevel;
     
 
+    RankComputer rankComputer;
+    rankComputer.reserve(nRows, nCols);
+    std::vector<int> originToM(s * (nRows + 1));
+
     for (unsigned int k=nRows-maxSubProj.back(); k >= s; k--){
-        unsigned int smallestFullRankIndex = iteration_on_k(baseMatrices, k, verbose-1);
+        unsigned int smallestFullRankIndex = iteration_on_k(packedMatrices, k, rankComputer, originToM, verbose-1);
         if (smallestFullRankIndex == nCols){
             continue;
         }
@@ -0,0 +1,300 @@
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/PackedGeneratingMatrix.h"
+
+#include <boost/iterator/function_output_iterator.hpp>
+
+#include <algorithm>
+#include <cassert>
+#include <stdexcept>
+
+namespace NetBuilder {
+
+constexpr unsigned int PackedGeneratingMatrix::WordSize;
+
+namespace {
+    // mask of the valid bits in the last word of a row with nCols columns
+    inline PackedGeneratingMatrix::Word lastWordMask(unsigned int nCols)
+    {
+        unsigned int r = nCols % PackedGeneratingMatrix::WordSize;
+        return (r == 0) ? ~PackedGeneratingMatrix::Word(0) : ((PackedGeneratingMatrix::Word(1) << r) - 1);
+    }
+}
+
+PackedGeneratingMatrix::PackedGeneratingMatrix(unsigned int nRows, unsigned int nCols):
+    m_data(nRows * nWords(nCols), 0),
+    m_nRows(nRows),
+    m_nCols(nCols),
+    m_nWords(nWords(nCols))
+{}
+
+PackedGeneratingMatrix::PackedGeneratingMatrix(unsigned int nRows, unsigned int nCols, const std::vector<uInteger>& init):
+    PackedGeneratingMatrix(nRows, nCols)
+{
+    assert(init.size() == m_nRows);
+    if (m_nWords == 0)
+    {
+        return;
+    }
+    for(unsigned int i = 0; i < m_nRows; ++i)
+    {
+        (*this)[i][0] = Word(init[i]) & (m_nWords == 1 ? lastWordMask(m_nCols) : ~Word(0));
+    }
+}
+
+PackedGeneratingMatrix::PackedGeneratingMatrix(const GeneratingMatrix& matrix):
+    PackedGeneratingMatrix(matrix.nRows(), matrix.nCols())
+{
+    for(unsigned int i = 0; i < m_nRows; ++i)
+    {
+        setRow(i, matrix, i);
+    }
+}
+
+void PackedGeneratingMatrix::setRow(unsigned int i, const GeneratingMatrix& matrix, unsigned int matrixRowIndex)
+{
+    resetRow(i);
+    if (m_nWords == 0)
+    {
+        return;
+    }
+    Word* row = (*this)[i];
+    const GeneratingMatrix::Row& src = matrix.m_data[matrixRowIndex];
+    unsigned int blockIndex = 0;
+    boost::to_block_range(src, boost::make_function_output_iterator([&](GeneratingMatrix::Row::block_type block)
+    {
+        // a block of boost::dynamic_bitset may be smaller than a word
+        unsigned int bit = blockIndex * GeneratingMatrix::Row::bits_per_block;
+        if (bit < m_nWords * WordSize)
+        {
+            row[bit / WordSize] |= Word(block) << (bit % WordSize);
+        }
+        ++blockIndex;
+    }));
+    row[m_nWords - 1] &= lastWordMask(m_nCols);
+}
+
+GeneratingMatrix PackedGeneratingMatrix::toGeneratingMatrix() const
+{
+    GeneratingMatrix res(m_nRows, m_nCols);
+    for(unsigned int i = 0; i < m_nRows; ++i)
+    {
+        const Word* row = (*this)[i];
+        for(unsigned int w = 0; w < m_nWords; ++w)
+        {
+            Word word = row[w];
+            while (word)
+            {
+                res(i, w * WordSize + countTrailingZeros(word)) = 1;
+                word &= word - 1;
+            }
+        }
+    }
+    return res;
+}
+
+void PackedGeneratingMatrix::resize(unsigned int nRows, unsigned int nCols)
+{
+    unsigned int newNWords = nWords(nCols);
+    if (newNWords != m_nWords)
+    {
+        std::vector<Word> data(nRows * newNWords, 0);
+        unsigned int nWordsToCopy = std::min(m_nWords, newNWords);
+        for(unsigned int i = 0; i < std::min(nRows, m_nRows); ++i)
+        {
+            std::copy_n(m_data.begin() + i * m_nWords, nWordsToCopy, data.begin() + i * newNWords);
+        }
+        m_data = std::move(data);
+    }
+    else
+    {
+        m_data.resize(nRows * newNWords, 0);
+    }
+    if (nCols < m_nCols && newNWords > 0)
+    {
+        const Word mask = lastWordMask(nCols);
+        for(unsigned int i = 0; i < std::min(nRows, m_nRows); ++i)
+        {
+            m_data[i * newNWords + newNWords - 1] &= mask;
+        }
+    }
+    m_nRows = nRows;
+    m_nCols = nCols;
+    m_nWords = newNWords;
+}
+
+void PackedGeneratingMatrix::swapRows(unsigned int i1, unsigned int i2)
+{
+    std::swap_ranges((*this)[i1], (*this)[i1] + m_nWords, (*this)[i2]);
+}
+
+PackedGeneratingMatrix PackedGeneratingMatrix::upperLeftSubMatrix(unsigned int nRows, unsigned int nCols) const
+{
+    return subMatrix(0, 0, nRows, nCols);
+}
+
+PackedGeneratingMatrix PackedGeneratingMatrix::subMatrix(unsigned int startingRow, unsigned int startingCol, unsigned int nRows, unsigned int nCols) const
+{
+    PackedGeneratingMatrix res(nRows, nCols);
+    if (res.m_nWords == 0)
+    {
+        return res;
+    }
+    const unsigned int wordShift = startingCol / WordSize;
+    const unsigned int bitShift = startingCol % WordSize;
+    const Word mask = lastWordMask(nCols);
+    for(unsigned int i = 0; i < nRows; ++i)
+    {
+        const Word* src = (*this)[startingRow + i];
+        Word* dest = res[i];
+        for(unsigned int w = 0; w < res.m_nWords; ++w)
+        {
+            unsigned int srcWord = w + wordShift;
+            Word word = (srcWord < m_nWords) ? (src[srcWord] >> bitShift) : 0;
+            if (bitShift != 0 && srcWord + 1 < m_nWords)
+            {
+                word |= src[srcWord + 1] << (WordSize - bitShift);
+            }
+            dest[w] = word;
+        }
+        dest[res.m_nWords - 1] &= mask;
+    }
+    return res;
+}
+
+void PackedGeneratingMatrix::stackBelow(const PackedGeneratingMatrix& block)
+{
+    assert(block.nCols() == m_nCols);
+    m_data.insert(m_data.end(), block.m_data.begin(), block.m_data.end());
+    m_nRows += block.nRows();
+}
+
+void PackedGeneratingMatrix::stackRight(const PackedGeneratingMatrix& block)
+{
+    assert(block.nRows() == m_nRows);
+    const unsigned int offset = m_nCols;
+    resize(m_nRows, m_nCols + block.nCols());
+    const unsigned int wordShift = offset / WordSize;
+    const unsigned int bitShift = offset % WordSize;
+    for(unsigned int i = 0; i < m_nRows; ++i)
+    {
+        Word* dest = (*this)[i];
+        const Word* src = block[i];
+        for(unsigned int w = 0; w < block.m_nWords; ++w)
+        {
+            dest[w + wordShift] |= src[w] << bitShift;
+            if (bitShift != 0 && w + wordShift + 1 < m_nWords)
+            {
+                dest[w + wordShift + 1] |= src[w] >> (WordSize - bitShift);
+            }
+        }
+    }
+}
+
+PackedGeneratingMatrix PackedGeneratingMatrix::operator*(const PackedGeneratingMatrix& m) const
+{
+    assert (nCols() == m.nRows());
+    PackedGeneratingMatrix res(nRows(), m.nCols());
+
+    for (unsigned int i = 0; i < nRows(); ++i)
+    {
+        Word* dest = res[i];
+        const Word* row = (*this)[i];
+        for (unsigned int w = 0; w < m_nWords; ++w)
+        {
+            Word word = row[w];
+            while (word)
+            {
+                const Word* src = m[w * WordSize + countTrailingZeros(word)];
+                for (unsigned int v = 0; v < res.m_nWords; ++v)
+                {
+                    dest[v] ^= src[v];
+                }
+                word &= word - 1;
+            }
+        }
+    }
+    return res;
+}
+
+std::ostream& operator<<(std::ostream& os, const PackedGeneratingMatrix& mat)
+{
+    for(unsigned int i = 0; i < mat.m_nRows; ++i)
+    {
+        for(unsigned int j = 0; j < mat.m_nCols; ++j)
+        {
+            os << mat(i,j);
+            if (j < mat.m_nCols - 1)
+                os << " ";
+        }
+        os << std::endl;
+    }
+    return os;
+}
+
+std::vector<unsigned long> PackedGeneratingMatrix::getColsReverse() const
+{
+    std::vector<unsigned long> res(nCols(), 0);
+    for (unsigned int i = 0; i < nRows(); ++i)
+    {
+        const Word* row = (*this)[i];
+        for (unsigned int w = 0; w < m_nWords; ++w)
+        {
+            Word word = row[w];
+            while (word)
+            {
+                res[w * WordSize + countTrailingZeros(word)] += 1UL << (nRows() - i - 1);
+                word &= word - 1;
+            }
+        }
+    }
+    return res;
+}
+
+PackedGeneratingMatrix PackedGeneratingMatrix::fromColsReverse(unsigned int nInputBits, unsigned int nOutputRows, const std::vector<unsigned long>& columns)
+{
+    PackedGeneratingMatrix result(nOutputRows, (unsigned int) columns.size());
+    for (unsigned int c = 0; c < columns.size(); ++c)
+    {
+        if (nInputBits < 8 * sizeof(unsigned long) && (columns[c] >> nInputBits) != 0)
+        {
+            throw std::runtime_error("The column in integer representation " + std::to_string(columns[c]) + "has more than " + std::to_string(nInputBits) + " bits.");
+        }
+        for (unsigned int row = 0; row < std::min(nInputBits, nOutputRows); ++row)
+        {
+            if ((columns[c] >> (nInputBits - 1 - row)) & 1)
+            {
+                result(row, c) = 1;
+            }
+        }
+    }
+    return result;
+}
+
+std::string PackedGeneratingMatrix::formatToColumnsReverse(unsigned int nBits) const
+{
+    const std::vector<unsigned long> columns = getColsReverse();
+    std::string res;
+    for(unsigned int i = 0; i < nCols(); ++i)
+    {
+        res += std::to_string(columns[i] << (nBits - nRows())) + " ";
+    }
+    res.pop_back();
+    return res;
+}
+
+}
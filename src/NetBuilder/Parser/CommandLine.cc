@@ -21,6 +21,8 @@
 #include "netbuilder/Parser/FigureParser.h"
 #include "netbuilder/Parser/ExplorationMethodParser.h"
 
+#include <tuple>
+
 namespace NetBuilder { namespace Parser {
 template <NetConstruction NC, EmbeddingType ET>
 std::unique_ptr<NetBuilder::Task::Task>
@@ -37,6 +39,14 @@ CommandLine<NC, ET>::parse()
             std::cout << "    Number of components: " << m_dimension << std::endl;
       }
       m_verbose = boost::lexical_cast<int>(s_verbose);
+      if (!s_shard.empty())
+      {
+            std::tie(m_shard, m_numShards) = lbp::splitPair<unsigned int, unsigned int>(s_shard, '/', 1);
+            if (m_numShards == 0 || m_shard >= m_numShards)
+            {
+                  throw lbp::ParserError("cannot parse shard string: the index of the shard must be smaller than the number of shards");
+            }
+      }
       m_figure = FigureParser<NC, ET>::parse(*this); // m_combiner initialized and moved to m_figure as a side effect 
       return ExplorationMethodParser<NC, ET>::parse(*this); // as a side effect, m_figure has been moved to task
 }
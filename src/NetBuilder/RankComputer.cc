@@ -1,381 +1,532 @@
-// This file is part of LatNet Builder.
-//
-// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
-//
-// Licensed under the Apache License, Version 2.0 (the "License");
-// you may not use this file except in compliance with the License.
-// You may obtain a copy of the License at
-//
-//     http://www.apache.org/licenses/LICENSE-2.0
-//
-// Unless required by applicable law or agreed to in writing, software
-// distributed under the License is distributed on an "AS IS" BASIS,
-// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
-// See the License for the specific language governing permissions and
-// limitations under the License.
-
-#include "netbuilder/Helpers/RankComputer.h"
-
-#include <algorithm>
-#include <iterator>
-
-namespace NetBuilder{
-
-    RankComputer::RankComputer(unsigned int nCols)
-    {
-        reset(nCols);
-    };
-
-    void RankComputer::reset(unsigned int nCols)  
-    {
-        m_nCols = nCols;
-        m_nRows = 0;
-        m_smallestFullRank = nCols;
-        m_redMat = GeneratingMatrix(0, m_nCols);
-        #ifdef DEBUG_ROW_REDUCER
-        m_baseMatrix = GeneratingMatrix(0, m_nCols);
-        #endif
-        m_columnsWithoutPivot.clear();
-        for(unsigned int j = 0; j < nCols; ++j)
-        {
-            m_columnsWithoutPivot.insert(m_columnsWithoutPivot.end(), j);
-        }
-        m_rowsWithoutPivot.clear();
-        m_pivotsColRowPositions.clear();
-        m_pivotsRowColPositions.clear();
-        m_rowOperations.resize(0,m_nCols);
-    }
-
-    unsigned int RankComputer::computeRank() const
-    {
-        return (unsigned int) m_pivotsColRowPositions.size();
-    }
-
-    std::vector<unsigned int> RankComputer::computeRanks(unsigned int firstCol, unsigned int numCol) const
-    {
-        unsigned int rank = 0;
-        std::vector<unsigned int> ranks(numCol, rank);
-        unsigned int lastCol = firstCol;
-
-        for(const auto& colRow : m_pivotsColRowPositions)
-        {
-            if(colRow.first >= firstCol+numCol)
-            {
-                break;
-            }
-
-            for(unsigned int col = lastCol; col < colRow.first ; ++col)
-            {
-                ranks[col-firstCol] = rank;
-            }
-
-            rank+=1;
-
-            if (colRow.first >= firstCol)
-            {
-                lastCol = colRow.first;
-            }
-        }
-
-        for(unsigned int col = lastCol; col < firstCol + numCol; ++col)
-        {
-            ranks[col-firstCol] = rank;
-        }
-
-        return ranks;
-    }
-
-    unsigned int RankComputer::pivotRowAndFindNewPivot(unsigned int rowIndex)
-    {
-
-        for( const auto& colRowPivot : m_pivotsColRowPositions)
-        {
-            
-            if (m_redMat(rowIndex,colRowPivot.first)) // if required, use the pivot to flip this bit
-            {
-                m_rowOperations[rowIndex] = m_rowOperations[rowIndex] ^ m_rowOperations[colRowPivot.second];
-                m_redMat[rowIndex] = m_redMat[rowIndex] ^ m_redMat[colRowPivot.second];
-            }
-        }
-
-        unsigned int newPivotColPosition = m_nCols;
-        for(std::set<unsigned int>::iterator it = m_columnsWithoutPivot.begin(); it != m_columnsWithoutPivot.end(); ++it)
-        {
-            if(m_redMat(rowIndex, *it))
-            {
-                newPivotColPosition = *it;
-                m_columnsWithoutPivot.erase(it); // this column will have a pivot
-                break;
-            }
-        }
-
-        if (newPivotColPosition < m_nCols) // if such a pivot exists
-        {
-            
-            m_pivotsColRowPositions[newPivotColPosition] = rowIndex;
-            m_pivotsRowColPositions[rowIndex] = newPivotColPosition;
-            for(unsigned int i = 0; i < m_nRows; ++i) // for each rowIndex above the inserted rowIndex
-            {
-                if(i != rowIndex && m_redMat(i, newPivotColPosition)) // if required, use the rowIndex to flip this bit
-                {
-                    m_redMat[i] = m_redMat[i] ^ m_redMat[rowIndex];
-                    m_rowOperations[i] = m_rowOperations[i] ^ m_rowOperations[rowIndex];
-                }
-            }
-            
-        }
-        else // if not
-        {
-            m_rowsWithoutPivot.push_back(rowIndex);
-        }
-        return newPivotColPosition;
-    }
-
-
-    void RankComputer::addRow(GeneratingMatrix newRow)
-    {
-        unsigned int row = m_nRows;
-        ++m_nRows;
-        m_rowOperations.resize(m_nRows, m_nRows);
-        m_rowOperations.flip(row,row);
-
-        #ifdef DEBUG_ROW_REDUCER
-        m_baseMatrix.stackBelow(newRow);
-        m_redMat.stackBelow(newRow);
-        #else
-        m_redMat.stackBelow(std::move(newRow));
-        #endif
-
-        pivotRowAndFindNewPivot(row);
-
-        if (m_pivotsColRowPositions.size() < m_nRows)
-        {
-            m_smallestFullRank = m_nCols + 1;
-        }
-        else
-        {
-            m_smallestFullRank = (*std::max_element(m_pivotsColRowPositions.begin(), m_pivotsColRowPositions.end())).first + 1;
-        }
-
-    }
-
-    void RankComputer::addColumn(GeneratingMatrix newCol)
-    {
-        newCol = m_rowOperations * newCol; // apply the row operations to the new column
-        m_redMat.stackRight(newCol); // stack right the new column
-
-        #ifdef DEBUG_ROW_REDUCER
-        m_baseMatrix.stackRight(newCol);
-        #endif
-
-        unsigned int col = m_nCols;
-        ++m_nCols;
-
-        unsigned int newPivotRowPosition = m_nRows;
-        for(std::list<unsigned int>::iterator it = m_rowsWithoutPivot.begin(); it != m_rowsWithoutPivot.end(); ++it)
-        {
-            if(m_redMat(*it,col))
-            {
-                newPivotRowPosition = *it;
-                m_rowsWithoutPivot.erase(it); // this row will have a pivot
-                break;
-            }
-        }
-
-        if(newPivotRowPosition < m_nRows)
-        {
-            m_pivotsColRowPositions[col] = newPivotRowPosition;
-            m_pivotsRowColPositions[newPivotRowPosition] = col;
-
-            for(unsigned int i = 0; i < m_nRows; ++i)
-            {
-                if( i != newPivotRowPosition && m_redMat(i,col))
-                {
-                    m_redMat.flip(i,col);
-                    m_rowOperations[i] = m_rowOperations[i] ^ m_rowOperations[newPivotRowPosition];
-                }
-            }
-        }
-        else
-        {
-            m_columnsWithoutPivot.insert(col);
-        }
-    }
-
-    void RankComputer::replaceRow(unsigned int rowIndex, GeneratingMatrix&& newRow, int verbose)
-    {
-        auto rowIndexColPivPos = m_pivotsRowColPositions.find(rowIndex);
-
-        if (rowIndexColPivPos != m_pivotsRowColPositions.end())
-        {
-            unsigned int colPositionPivot = (*rowIndexColPivPos).second;
-            unsigned int firstRowToDepivot = 0;
-            if (m_rowOperations(rowIndex, rowIndex) != 1){
-                for(unsigned int tmpIndex = 0; tmpIndex < m_nRows; ++tmpIndex)
-                {
-                    if(m_rowOperations(tmpIndex,rowIndex)){
-                        m_redMat.swapRows(tmpIndex, rowIndex);
-                        m_rowOperations.swapRows(tmpIndex, rowIndex);
-
-                        auto tmpIndexPivPos = m_pivotsRowColPositions.find(tmpIndex);
-                        int tmpIndexColPivPos;
-                        if(tmpIndexPivPos != m_pivotsRowColPositions.end())
-                        {
-                            tmpIndexColPivPos = (*tmpIndexPivPos).second;
-                            m_pivotsColRowPositions.erase(tmpIndexColPivPos);
-                            m_columnsWithoutPivot.insert(tmpIndexColPivPos);
-                        }
-                        
-                        m_pivotsRowColPositions.erase(rowIndex);
-                        m_pivotsColRowPositions[colPositionPivot] = tmpIndex;
-                        m_pivotsRowColPositions[tmpIndex] = colPositionPivot;
-                        
-                        firstRowToDepivot = tmpIndex+1;
-                        break;
-                    }
-                }
-            }
-            else{
-                m_pivotsRowColPositions.erase(rowIndex);
-                m_pivotsColRowPositions.erase(colPositionPivot);
-                m_columnsWithoutPivot.insert(colPositionPivot);
-            }
-
-            for(unsigned int i = firstRowToDepivot; i < m_nRows; ++i)
-            {
-                if(i!=rowIndex && m_rowOperations(i,rowIndex))
-                {
-                    m_redMat[i] = m_redMat[i] ^ m_redMat[rowIndex];
-                    m_rowOperations[i] = m_rowOperations[i] ^ m_rowOperations[rowIndex];
-                }
-            }
-        }
-
-        #ifdef DEBUG_ROW_REDUCER
-        m_redMat[rowIndex] = newRow[0];
-        m_baseMatrix[rowIndex] = newRow[0];
-        #else
-        m_redMat[rowIndex] = std::move(newRow[0]);
-        #endif
-
-        m_rowOperations[rowIndex].reset();
-        m_rowOperations(rowIndex, rowIndex) = 1;
-
-        unsigned int newPivotPos = pivotRowAndFindNewPivot(rowIndex);
-
-        m_smallestFullRank = std::max(m_smallestFullRank, newPivotPos + 1);
-    }
-
-    bool RankComputer::checkIfInvertible(GeneratingMatrix matrix)
-    {
-        int k = matrix.nRows();
-        int m = matrix.nCols();
-
-        if (k != m)
-        {
-            return false;
-        }
-        
-        int i_pivot=0;
-        int j=-1;
-        int Pivots[k];
-        for (int i=0; i<k; i++){
-            Pivots[i] = -1;
-        }
-        
-        while (i_pivot < k && j < m-1){
-            j++;
-            int i_temp = i_pivot;
-            while (i_temp < k && matrix[i_temp][j] == 0){
-                i_temp++;
-            }
-            if (i_temp >= k){  // pas d'element non nul sur la colonne
-                continue;
-            }
-            matrix.swapRows(i_temp, i_pivot);
-
-            Pivots[i_pivot] = j;
-            for (int i=i_pivot+1; i<k; i++){
-                if (matrix[i][j] != 0){
-                    matrix[i] = matrix[i] ^ matrix[i_pivot];
-                }
-            }
-            i_pivot++;
-        }
-
-        return Pivots[k-1] != -1;
-    }
-
-#ifdef DEBUG_ROW_REDUCER
-void RankComputer::check(){
-
-    if (!checkIfInvertible(m_rowOperations))
-    {
-        throw std::runtime_error("Row operations matrix is not invertible.")
-    }
-
-    std::vector<bool> check_row (m_nRows, 0);
-    std::vector<bool> check_col (m_nCols, 0);
-
-    GeneratingMatrix prod = m_rowOperations * m_baseMatrix;
-    for (int i=0; i < m_nRows; i++){
-        for (int j=0; j < m_nCols; j++){
-            if (prod(i, j) != m_redMat(i, j)){
-                throw std::runtime_error("The left-product of the base matrix by the row-operations matrix does not correspond to the reduced matrix.s");
-            }
-        }
-    }
-
-    for (const auto& colRow : m_pivotsColRowPositions){
-        unsigned int col = colRow.first;
-        unsigned int row = colRow.second;
-        for (unsigned int i=0; i < m_nRows; i++){
-            if (m_redMat(i, col) != (i == row)){
-                throw std::runtime_error("A column containing a pivot has not the good property.");
-            }
-        }
-        check_row[row] = 1;
-        check_col[col] = 1;
-    }
-
-    for (const auto& rowCol : m_pivotsRowColPositions){
-        unsigned int row = rowCol.first;
-        unsigned int col = rowCol.second;
-        if (check_row[row] != 1 || check_col[col] != 1){
-            throw std::runtime_error("RowCol and ColRow maps are incompatible (1) .");
-        }
-        if (m_pivotsColRowPositions[col] != row){
-            throw std::runtime_error("RowCol and ColRow maps are incompatible (2) .");
-        }
-    }
-    if (m_pivotsColRowPositions.size() != m_pivotsRowColPositions.size()){
-        throw std::runtime_error("RowCol and ColRow maps are incompatible (3) .");
-    }
-
-    for (const auto& col: m_columnsWithoutPivot){
-        if (check_col[col] != 0){
-            throw std::runtime_error("Column without pivot in pivot map.");
-        }
-        check_col[col] = 1;
-    }
-    for (const auto& row: m_rowsWithoutPivot){
-        if (check_row[row] != 0){
-            throw std::runtime_error("Row without pivot in pivot map.");
-        }
-        check_row[row] = 1;
-    }
-
-    for (const auto& r: check_row){
-        if(r != 1){
-            throw std::runtime_error("Duplicate or missing row.");
-        }
-    }
-    for (const auto& c : check_col){
-        if(c != 1){
-            throw std::runtime_error("Duplicate or missing column.");
-        }
-    }
-}
-#endif
-
-}
+// This file is part of LatNet Builder.
+//
+// Copyright (C) 2012-2021  The LatNet Builder author's, supervised by Pierre L'Ecuyer, Universite de Montreal.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "netbuilder/Helpers/RankComputer.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+
+namespace NetBuilder{
+
+    constexpr unsigned int RankComputer::NoPivot;
+
+    namespace {
+        typedef PackedGeneratingMatrix::Word Word;
+
+        inline unsigned int nWords(unsigned int nBits) { return PackedGeneratingMatrix::nWords(nBits); }
+
+        inline void setBit(std::vector<Word>& mask, unsigned int i) { mask[i / PackedGeneratingMatrix::WordSize] |= Word(1) << (i % PackedGeneratingMatrix::WordSize); }
+
+        inline void clearBit(std::vector<Word>& mask, unsigned int i) { mask[i / PackedGeneratingMatrix::WordSize] &= ~(Word(1) << (i % PackedGeneratingMatrix::WordSize)); }
+
+        inline bool parity(Word word)
+        {
+            #if defined(__GNUC__)
+            return __builtin_parityll(word);
+            #else
+            bool res = false;
+            while (word) { res = !res; word &= word - 1; }
+            return res;
+            #endif
+        }
+    }
+
+    RankComputer::RankComputer(unsigned int nCols)
+    {
+        reset(nCols);
+    };
+
+    void RankComputer::reserve(unsigned int nRows, unsigned int nCols)
+    {
+        if (nRows <= m_rowCapacity && nCols <= m_colCapacity)
+        {
+            return;
+        }
+        m_rowCapacity = std::max(nRows, m_rowCapacity);
+        m_colCapacity = std::max(nCols, m_colCapacity);
+        m_redMat.resize(m_rowCapacity, m_colCapacity);
+        m_rowOperations.resize(m_rowCapacity, m_rowCapacity);
+        #ifdef DEBUG_ROW_REDUCER
+        m_baseMatrix.resize(m_rowCapacity, m_colCapacity);
+        #endif
+        m_pivotRowOfCol.resize(m_colCapacity, NoPivot);
+        m_pivotColOfRow.resize(m_rowCapacity, NoPivot);
+        m_colsWithPivot.resize(nWords(m_colCapacity), 0);
+        m_rowsWithPivot.resize(nWords(m_rowCapacity), 0);
+        m_colBuffer.resize(nWords(m_rowCapacity), 0);
+    }
+
+    void RankComputer::reset(unsigned int nCols)  
+    {
+        reserve(0, nCols);
+        for(unsigned int i = 0; i < m_nRows; ++i)
+        {
+            m_redMat.resetRow(i);
+            m_rowOperations.resetRow(i);
+            #ifdef DEBUG_ROW_REDUCER
+            m_baseMatrix.resetRow(i);
+            #endif
+        }
+        std::fill(m_pivotRowOfCol.begin(), m_pivotRowOfCol.end(), NoPivot);
+        std::fill(m_pivotColOfRow.begin(), m_pivotColOfRow.end(), NoPivot);
+        std::fill(m_colsWithPivot.begin(), m_colsWithPivot.end(), 0);
+        std::fill(m_rowsWithPivot.begin(), m_rowsWithPivot.end(), 0);
+        m_nCols = nCols;
+        m_nRows = 0;
+        m_rank = 0;
+        m_smallestFullRank = nCols;
+    }
+
+    std::map<unsigned int, unsigned int> RankComputer::getPivots() const
+    {
+        std::map<unsigned int, unsigned int> res;
+        for(unsigned int i = 0; i < m_nRows; ++i)
+        {
+            if (m_pivotColOfRow[i] != NoPivot)
+            {
+                res[i] = m_pivotColOfRow[i];
+            }
+        }
+        return res;
+    }
+
+    std::vector<unsigned int> RankComputer::computeRanks(unsigned int firstCol, unsigned int numCol) const
+    {
+        unsigned int rank = 0;
+        std::vector<unsigned int> ranks(numCol, rank);
+        unsigned int lastCol = firstCol;
+
+        for(unsigned int w = 0; w < nWords(m_nCols); ++w)
+        {
+            Word pivots = m_colsWithPivot[w];
+            while (pivots)
+            {
+                unsigned int pivotCol = w * PackedGeneratingMatrix::WordSize + PackedGeneratingMatrix::countTrailingZeros(pivots);
+                pivots &= pivots - 1;
+
+                if(pivotCol >= firstCol+numCol)
+                {
+                    break;
+                }
+
+                for(unsigned int col = lastCol; col < pivotCol ; ++col)
+                {
+                    ranks[col-firstCol] = rank;
+                }
+
+                rank+=1;
+
+                if (pivotCol >= firstCol)
+                {
+                    lastCol = pivotCol;
+                }
+            }
+        }
+
+        for(unsigned int col = lastCol; col < firstCol + numCol; ++col)
+        {
+            ranks[col-firstCol] = rank;
+        }
+
+        return ranks;
+    }
+
+    void RankComputer::setPivot(unsigned int row, unsigned int col)
+    {
+        m_pivotRowOfCol[col] = row;
+        m_pivotColOfRow[row] = col;
+        setBit(m_colsWithPivot, col);
+        setBit(m_rowsWithPivot, row);
+        ++m_rank;
+    }
+
+    void RankComputer::removePivotOfCol(unsigned int col)
+    {
+        unsigned int row = m_pivotRowOfCol[col];
+        if (row == NoPivot)
+        {
+            return;
+        }
+        m_pivotRowOfCol[col] = NoPivot;
+        clearBit(m_colsWithPivot, col);
+        if (m_pivotColOfRow[row] == col)
+        {
+            m_pivotColOfRow[row] = NoPivot;
+            clearBit(m_rowsWithPivot, row);
+        }
+        --m_rank;
+    }
+
+    unsigned int RankComputer::pivotRowAndFindNewPivot(unsigned int rowIndex)
+    {
+        const unsigned int nColWords = nWords(m_nCols);
+
+        for(unsigned int w = 0; w < nColWords; ++w)
+        {
+            Word pivots = m_colsWithPivot[w];
+            while (pivots)
+            {
+                unsigned int pivotCol = w * PackedGeneratingMatrix::WordSize + PackedGeneratingMatrix::countTrailingZeros(pivots);
+                pivots &= pivots - 1;
+                if (m_redMat(rowIndex, pivotCol)) // if required, use the pivot to flip this bit
+                {
+                    m_rowOperations.xorRow(rowIndex, m_pivotRowOfCol[pivotCol]);
+                    m_redMat.xorRow(rowIndex, m_pivotRowOfCol[pivotCol]);
+                }
+            }
+        }
+
+        unsigned int newPivotColPosition = m_nCols;
+        const Word* row = m_redMat[rowIndex];
+        for(unsigned int w = 0; w < nColWords; ++w)
+        {
+            Word candidates = row[w] & ~m_colsWithPivot[w]; // non-zero elements in columns without a pivot
+            if (candidates)
+            {
+                newPivotColPosition = w * PackedGeneratingMatrix::WordSize + PackedGeneratingMatrix::countTrailingZeros(candidates);
+                break;
+            }
+        }
+
+        if (newPivotColPosition < m_nCols) // if such a pivot exists
+        {
+            setPivot(rowIndex, newPivotColPosition);
+            for(unsigned int i = 0; i < m_nRows; ++i) // for each rowIndex above the inserted rowIndex
+            {
+                if(i != rowIndex && m_redMat(i, newPivotColPosition)) // if required, use the rowIndex to flip this bit
+                {
+                    m_redMat.xorRow(i, rowIndex);
+                    m_rowOperations.xorRow(i, rowIndex);
+                }
+            }
+        }
+        return newPivotColPosition;
+    }
+
+    void RankComputer::copyRow(unsigned int rowIndex, const PackedGeneratingMatrix& matrix, unsigned int matrixRowIndex)
+    {
+        Word* dest = m_redMat[rowIndex];
+        const Word* src = matrix[matrixRowIndex];
+        const unsigned int nColWords = nWords(m_nCols);
+        const unsigned int nWordsToCopy = std::min(nColWords, matrix.nWordsPerRow());
+        std::copy_n(src, nWordsToCopy, dest);
+        std::fill(dest + nWordsToCopy, dest + m_redMat.nWordsPerRow(), 0);
+        clearColumnsBeyondEnd(rowIndex);
+        #ifdef DEBUG_ROW_REDUCER
+        std::copy_n(m_redMat[rowIndex], m_redMat.nWordsPerRow(), m_baseMatrix[rowIndex]);
+        #endif
+    }
+
+    void RankComputer::copyRow(unsigned int rowIndex, const GeneratingMatrix& matrix, unsigned int matrixRowIndex)
+    {
+        m_redMat.setRow(rowIndex, matrix, matrixRowIndex);
+        clearColumnsBeyondEnd(rowIndex);
+        #ifdef DEBUG_ROW_REDUCER
+        std::copy_n(m_redMat[rowIndex], m_redMat.nWordsPerRow(), m_baseMatrix[rowIndex]);
+        #endif
+    }
+
+    void RankComputer::clearColumnsBeyondEnd(unsigned int rowIndex)
+    {
+        Word* dest = m_redMat[rowIndex];
+        const unsigned int nColWords = nWords(m_nCols);
+        std::fill(dest + nColWords, dest + m_redMat.nWordsPerRow(), 0);
+        if (m_nCols % PackedGeneratingMatrix::WordSize != 0)
+        {
+            dest[nColWords - 1] &= (Word(1) << (m_nCols % PackedGeneratingMatrix::WordSize)) - 1;
+        }
+    }
+
+    void RankComputer::addRow(GeneratingMatrix newRow)
+    {
+        addRow(PackedGeneratingMatrix(newRow), 0);
+    }
+
+    void RankComputer::addRow(const PackedGeneratingMatrix& matrix, unsigned int rowIndex)
+    {
+        unsigned int row = appendRow();
+        copyRow(row, matrix, rowIndex);
+        reduceAppendedRow(row);
+    }
+
+    void RankComputer::addRow(const GeneratingMatrix& matrix, unsigned int rowIndex)
+    {
+        unsigned int row = appendRow();
+        copyRow(row, matrix, rowIndex);
+        reduceAppendedRow(row);
+    }
+
+    unsigned int RankComputer::appendRow()
+    {
+        if (m_nRows == m_rowCapacity)
+        {
+            reserve(std::max(2 * m_rowCapacity, 1u), m_nCols);
+        }
+
+        unsigned int row = m_nRows;
+        ++m_nRows;
+        m_rowOperations.flip(row,row);
+        return row;
+    }
+
+    void RankComputer::reduceAppendedRow(unsigned int row)
+    {
+        pivotRowAndFindNewPivot(row);
+
+        if (m_rank < m_nRows)
+        {
+            m_smallestFullRank = m_nCols + 1;
+        }
+        else
+        {
+            unsigned int w = nWords(m_nCols);
+            while (m_colsWithPivot[w-1] == 0)
+            {
+                --w;
+            }
+            Word lastWord = m_colsWithPivot[w-1];
+            unsigned int lastPivotCol = (w-1) * PackedGeneratingMatrix::WordSize;
+            while (lastWord >>= 1)
+            {
+                ++lastPivotCol;
+            }
+            m_smallestFullRank = lastPivotCol + 1;
+        }
+
+    }
+
+    void RankComputer::addColumn(GeneratingMatrix newCol)
+    {
+        std::fill(m_colBuffer.begin(), m_colBuffer.end(), 0);
+        for(unsigned int i = 0; i < m_nRows; ++i)
+        {
+            if (newCol(i, 0))
+            {
+                setBit(m_colBuffer, i);
+            }
+        }
+        addColumn(m_colBuffer.data());
+    }
+
+    void RankComputer::addColumn(const Word* newCol)
+    {
+        if (m_nCols == m_colCapacity)
+        {
+            reserve(m_nRows, std::max(2 * m_colCapacity, 1u));
+        }
+
+        unsigned int col = m_nCols;
+        ++m_nCols;
+
+        const unsigned int nRowWords = nWords(m_nRows);
+
+        // apply the row operations to the new column and stack it on the right
+        for(unsigned int i = 0; i < m_nRows; ++i)
+        {
+            const Word* rowOperations = m_rowOperations[i];
+            Word product = 0;
+            for(unsigned int w = 0; w < nRowWords; ++w)
+            {
+                product ^= rowOperations[w] & newCol[w];
+            }
+            if (parity(product))
+            {
+                m_redMat.flip(i, col);
+            }
+            #ifdef DEBUG_ROW_REDUCER
+            m_baseMatrix(i, col) = (newCol[i / PackedGeneratingMatrix::WordSize] >> (i % PackedGeneratingMatrix::WordSize)) & 1;
+            #endif
+        }
+
+        unsigned int newPivotRowPosition = m_nRows;
+        for(unsigned int w = 0; w < nRowWords && newPivotRowPosition == m_nRows; ++w)
+        {
+            Word rowsWithoutPivot = ~m_rowsWithPivot[w];
+            while (rowsWithoutPivot)
+            {
+                unsigned int row = w * PackedGeneratingMatrix::WordSize + PackedGeneratingMatrix::countTrailingZeros(rowsWithoutPivot);
+                rowsWithoutPivot &= rowsWithoutPivot - 1;
+                if (row >= m_nRows)
+                {
+                    break;
+                }
+                if (m_redMat(row, col))
+                {
+                    newPivotRowPosition = row;
+                    break;
+                }
+            }
+        }
+
+        if(newPivotRowPosition < m_nRows)
+        {
+            setPivot(newPivotRowPosition, col);
+
+            for(unsigned int i = 0; i < m_nRows; ++i)
+            {
+                if( i != newPivotRowPosition && m_redMat(i,col))
+                {
+                    m_redMat.flip(i,col);
+                    m_rowOperations.xorRow(i, newPivotRowPosition);
+                }
+            }
+        }
+    }
+
+    void RankComputer::replaceRow(unsigned int rowIndex, GeneratingMatrix&& newRow, int verbose)
+    {
+        replaceRow(rowIndex, PackedGeneratingMatrix(newRow), 0, verbose);
+    }
+
+    void RankComputer::replaceRow(unsigned int rowIndex, const PackedGeneratingMatrix& matrix, unsigned int matrixRowIndex, int verbose)
+    {
+        if (m_pivotColOfRow[rowIndex] != NoPivot)
+        {
+            unsigned int colPositionPivot = m_pivotColOfRow[rowIndex];
+            unsigned int firstRowToDepivot = 0;
+            if (!m_rowOperations(rowIndex, rowIndex)){
+                for(unsigned int tmpIndex = 0; tmpIndex < m_nRows; ++tmpIndex)
+                {
+                    if(m_rowOperations(tmpIndex,rowIndex)){
+                        m_redMat.swapRows(tmpIndex, rowIndex);
+                        m_rowOperations.swapRows(tmpIndex, rowIndex);
+
+                        if(m_pivotColOfRow[tmpIndex] != NoPivot)
+                        {
+                            removePivotOfCol(m_pivotColOfRow[tmpIndex]);
+                        }
+
+                        // the pivot of rowIndex is transfered to tmpIndex
+                        m_pivotColOfRow[rowIndex] = NoPivot;
+                        clearBit(m_rowsWithPivot, rowIndex);
+                        m_pivotRowOfCol[colPositionPivot] = tmpIndex;
+                        m_pivotColOfRow[tmpIndex] = colPositionPivot;
+                        setBit(m_rowsWithPivot, tmpIndex);
+                        
+                        firstRowToDepivot = tmpIndex+1;
+                        break;
+                    }
+                }
+            }
+            else{
+                removePivotOfCol(colPositionPivot);
+            }
+
+            for(unsigned int i = firstRowToDepivot; i < m_nRows; ++i)
+            {
+                if(i!=rowIndex && m_rowOperations(i,rowIndex))
+                {
+                    m_redMat.xorRow(i, rowIndex);
+                    m_rowOperations.xorRow(i, rowIndex);
+                }
+            }
+        }
+
+        copyRow(rowIndex, matrix, matrixRowIndex);
+
+        m_rowOperations.resetRow(rowIndex);
+        m_rowOperations(rowIndex, rowIndex) = 1;
+
+        unsigned int newPivotPos = pivotRowAndFindNewPivot(rowIndex);
+
+        m_smallestFullRank = std::max(m_smallestFullRank, newPivotPos + 1);
+    }
+
+    bool RankComputer::checkIfInvertible(GeneratingMatrix matrix)
+    {
+        unsigned int k = matrix.nRows();
+        unsigned int m = matrix.nCols();
+
+        if (k != m)
+        {
+            return false;
+        }
+
+        PackedGeneratingMatrix packed(matrix);
+        
+        unsigned int i_pivot = 0;
+        for (unsigned int j = 0; j < m && i_pivot < k; ++j){
+            unsigned int i_temp = i_pivot;
+            while (i_temp < k && !packed(i_temp, j)){
+                i_temp++;
+            }
+            if (i_temp >= k){  // pas d'element non nul sur la colonne
+                continue;
+            }
+            packed.swapRows(i_temp, i_pivot);
+
+            for (unsigned int i = i_pivot+1; i < k; ++i){
+                if (packed(i, j)){
+                    packed.xorRow(i, i_pivot);
+                }
+            }
+            i_pivot++;
+        }
+
+        return i_pivot == k;
+    }
+
+#ifdef DEBUG_ROW_REDUCER
+void RankComputer::check(){
+
+    if (!checkIfInvertible(rowOperationsCopy().toGeneratingMatrix()))
+    {
+        throw std::runtime_error("Row operations matrix is not invertible.");
+    }
+
+    PackedGeneratingMatrix prod = rowOperationsCopy() * baseMatrixCopy();
+    for (unsigned int i=0; i < m_nRows; i++){
+        for (unsigned int j=0; j < m_nCols; j++){
+            if (prod(i, j) != m_redMat(i, j)){
+                throw std::runtime_error("The left-product of the base matrix by the row-operations matrix does not correspond to the reduced matrix.s");
+            }
+        }
+    }
+
+    unsigned int rank = 0;
+    for (unsigned int col=0; col < m_nCols; col++){
+        unsigned int row = m_pivotRowOfCol[col];
+        bool hasPivot = (m_colsWithPivot[col / PackedGeneratingMatrix::WordSize] >> (col % PackedGeneratingMatrix::WordSize)) & 1;
+        if (hasPivot != (row != NoPivot)){
+            throw std::runtime_error("Column bitmask and pivot array are incompatible.");
+        }
+        if (row == NoPivot){
+            continue;
+        }
+        ++rank;
+        if (m_pivotColOfRow[row] != col){
+            throw std::runtime_error("Row and column pivot arrays are incompatible.");
+        }
+        for (unsigned int i=0; i < m_nRows; i++){
+            if (m_redMat(i, col) != (i == row)){
+                throw std::runtime_error("A column containing a pivot has not the good property.");
+            }
+        }
+    }
+    for (unsigned int row=0; row < m_nRows; row++){
+        bool hasPivot = (m_rowsWithPivot[row / PackedGeneratingMatrix::WordSize] >> (row % PackedGeneratingMatrix::WordSize)) & 1;
+        if (hasPivot != (m_pivotColOfRow[row] != NoPivot)){
+            throw std::runtime_error("Row bitmask and pivot array are incompatible.");
+        }
+    }
+    if (rank != m_rank){
+        throw std::runtime_error("Wrong number of pivots.");
+    }
+}
+#endif
+
+}
@@ -15,10 +15,11 @@
 // limitations under the License.
 
 #include "netbuilder/FigureOfMerit/TValueComputation.h"
+#include "netbuilder/PackedGeneratingMatrix.h"
 #include "netbuilder/Types.h"
 #include "netbuilder/Helpers/CompositionMaker.h"
 
-#include <list>
+#include <algorithm>
 
 namespace NetBuilder {
 
@@ -31,9 +32,148 @@ getmsb (unsigned long long x)
     return r;
 }
 
-typedef GeneratingMatrix GeneratingMatrix;
+typedef PackedGeneratingMatrix::Word Word;
 
-unsigned int SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices, unsigned int maxTValuesSubProj, int verbose=0)
+namespace {
+
+#if defined(__GNUC__)
+
+/*
+ * Kernel for matrices with at most 64 columns. Each selected row is a single word, and the Gray-code walk is
+ * performed simultaneously for NumLanes compositions (of the same integer k), stored in the lanes of a vector.
+ * With GCC on x86-64 Linux, the kernel is compiled for AVX-512, AVX2 and the baseline instruction set, and the best version
+ * is selected at runtime. Otherwise, the compiler lowers the vector operations to the available instructions.
+ */
+#define NETBUILDER_SCHMID_WORD_KERNEL
+
+constexpr unsigned int NumLanes = 8;
+
+typedef Word WordLanes __attribute__((vector_size(NumLanes * sizeof(Word))));
+
+// target_clones requires GCC 6 or later and ifunc support from the C library.
+#if defined(__x86_64__) && defined(__GLIBC__) && defined(__GNUC__) && __GNUC__ >= 6 && !defined(__clang__)
+#define NETBUILDER_SCHMID_TARGETS __attribute__((target_clones("avx512f", "avx2", "default")))
+#else
+#define NETBUILDER_SCHMID_TARGETS
+#endif
+
+constexpr unsigned int ZeroCombination = PackedGeneratingMatrix::WordSize; // returned when a combination of rows is null
+
+inline bool anyLane(const WordLanes& x)
+{
+    Word res = 0;
+    for(unsigned int lane = 0; lane < NumLanes; ++lane)
+    {
+        res |= x[lane];
+    }
+    return res != 0;
+}
+
+/*
+ * Walks the first nSteps combinations in Gray-code order of the rows of each lane. Returns ZeroCombination as soon as
+ * a null combination is found (checked every 64 steps). Otherwise, returns 0 if TrackTrailingZeros is false, and the maximal number of
+ * trailing zeros of the combinations if TrackTrailingZeros is true.
+ */
+template <bool TrackTrailingZeros>
+inline __attribute__((always_inline)) unsigned int grayCodeWalk(const WordLanes* rows, const unsigned int* flipingOrder, uInteger nSteps)
+{
+    WordLanes v = {};
+    WordLanes zeros = {};
+    WordLanes lowestBits = {};
+    for(uInteger r = 0; r < nSteps; ++r)
+    {
+        v ^= rows[flipingOrder[r]];
+        zeros |= (WordLanes) (v == 0);
+        if (TrackTrailingZeros)
+        {
+            WordLanes lowestBit = v & -v;
+            lowestBits = (lowestBit > lowestBits) ? lowestBit : lowestBits;
+        }
+        if ((r & 63) == 63 && anyLane(zeros))
+        {
+            return ZeroCombination;
+        }
+    }
+    if (anyLane(zeros))
+    {
+        return ZeroCombination;
+    }
+    unsigned int res = 0;
+    if (TrackTrailingZeros)
+    {
+        for(unsigned int lane = 0; lane < NumLanes; ++lane)
+        {
+            if (lowestBits[lane])
+            {
+                res = std::max(res, PackedGeneratingMatrix::countTrailingZeros(lowestBits[lane]));
+            }
+        }
+    }
+    return res;
+}
+
+NETBUILDER_SCHMID_TARGETS
+bool hasZeroCombination(const WordLanes* rows, const unsigned int* flipingOrder, uInteger nSteps)
+{
+    return grayCodeWalk<false>(rows, flipingOrder, nSteps) == ZeroCombination;
+}
+
+NETBUILDER_SCHMID_TARGETS
+unsigned int maxTrailingZeros(const WordLanes* rows, const unsigned int* flipingOrder, uInteger nSteps)
+{
+    return grayCodeWalk<true>(rows, flipingOrder, nSteps);
+}
+
+/*
+ * Calls func on the rows of batches of NumLanes compositions of k into s parts. Unused lanes of the last batch are
+ * filled with copies of the last composition. Stops as soon as func returns true.
+ */
+template <typename FUNC>
+void forEachBatchOfCompositions(const std::vector<PackedGeneratingMatrix>& matrices, unsigned int k, FUNC&& func)
+{
+    const unsigned int s = (unsigned int) matrices.size();
+    WordLanes rows[PackedGeneratingMatrix::WordSize];
+    CompositionMaker compMaker(k, s);
+    unsigned int lane = 0;
+    bool notDepleted = true;
+    do
+    {
+        const std::vector<unsigned int>& comp = compMaker.currentComposition();
+        unsigned int idx = 0;
+        for(Dimension coord = 0; coord < s; ++coord)
+        {
+            for(unsigned int j = 0; j < comp[coord]; ++j)
+            {
+                rows[idx][lane] = matrices[coord][j][0];
+                ++idx;
+            }
+        }
+        ++lane;
+        notDepleted = compMaker.goToNextComposition();
+        if (lane == NumLanes || !notDepleted)
+        {
+            for(unsigned int l = lane; l < NumLanes; ++l)
+            {
+                for(unsigned int i = 0; i < k; ++i)
+                {
+                    rows[i][l] = rows[i][lane-1];
+                }
+            }
+            if (func(rows))
+            {
+                return;
+            }
+            lane = 0;
+        }
+    }
+    while(notDepleted);
+}
+
+#endif
+
+}
+
+unsigned int SchmidMethod::computeTValue(ProjectionView matrices, unsigned int maxTValuesSubProj, int verbose=0)
 {
     unsigned int m = matrices[0].nCols();
     unsigned int s = (unsigned int)matrices.size();
@@ -47,27 +187,58 @@ unsigned int SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices,
         flipingOrder[r] = getmsb(((r >> 1) ^ r)^(((r+1) >> 1) ^ (r+1)));
     }
 
+    std::vector<PackedGeneratingMatrix> packedMatrices(matrices.begin(), matrices.end());
+
+    #ifdef NETBUILDER_SCHMID_WORD_KERNEL
+    if (m <= PackedGeneratingMatrix::WordSize)
+    {
+        for(unsigned int k = s ; k <= m-maxTValuesSubProj; ++k)
+        {
+            bool found = false;
+            forEachBatchOfCompositions(packedMatrices, k, [&](const WordLanes* rows)
+            {
+                found = hasZeroCombination(rows, flipingOrder.data(), (uInteger) ((1 << k) - 1));
+                return found;
+            });
+            if (found)
+            {
+                return m-(k-1);
+            }
+        }
+        return maxTValuesSubProj;
+    }
+    #endif
+
+    const unsigned int nWords = PackedGeneratingMatrix::nWords(m);
+    std::vector<Word> v(nWords);
+
     for(unsigned int k = s ; k <= m-maxTValuesSubProj; ++k)
     {
         CompositionMaker compMaker(k,s);
+        std::vector<const Word*> tmp(k);
         do
         { 
-            std::vector<unsigned int> comp = compMaker.currentComposition();
-            std::vector<GeneratingMatrix::Row*> tmp(k);
+            const std::vector<unsigned int>& comp = compMaker.currentComposition();
             unsigned int idx = 0;
             for(Dimension coord = 0; coord < s; ++coord)
             {
                 for(unsigned int j = 0; j < comp[coord]; ++j)
                 {
-                    tmp[idx] = &(matrices[coord][j]);
+                    tmp[idx] = packedMatrices[coord][j];
                     ++idx;
                 }
             }
-            boost::dynamic_bitset<> v(m);
+            std::fill(v.begin(), v.end(), 0);
             for(uInteger r = 0; r < (unsigned int) ((1 << k) - 1); ++r)
             {
-                v ^= *tmp[flipingOrder[r]];
-                if (v.none())
+                const Word* row = tmp[flipingOrder[r]];
+                Word none = 0;
+                for(unsigned int w = 0; w < nWords; ++w)
+                {
+                    v[w] ^= row[w];
+                    none |= v[w];
+                }
+                if (!none)
                 {
                     return m-(k-1);
                 }
@@ -78,7 +249,7 @@ unsigned int SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices,
     return maxTValuesSubProj;
 }
 
-std::vector<unsigned int> SchmidMethod::computeTValue(std::vector<GeneratingMatrix> matrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose=0)
+std::vector<unsigned int> SchmidMethod::computeTValue(ProjectionView matrices, const std::vector<unsigned int>& maxTValuesSubProj, int verbose=0)
 {
     unsigned int m = matrices[0].nCols();
     unsigned int s = (unsigned int)matrices.size();
@@ -90,64 +261,97 @@ std::vector<unsigned int> SchmidMethod::computeTValue(std::vector<GeneratingMatr
 
     upperLimit= (1<<(m-maxTValuesSubProj.back()))-1;
 
-    std::list<unsigned int> flipingOrder;
+    std::vector<unsigned int> flipingOrder(upperLimit);
     for(uInteger r = 0; r < upperLimit; ++r)
     {
-        flipingOrder.push_back(getmsb(((r >> 1) ^ r)^(((r+1) >> 1) ^ (r+1))));
+        flipingOrder[r] = getmsb(((r >> 1) ^ r)^(((r+1) >> 1) ^ (r+1)));
     }
 
+    std::vector<PackedGeneratingMatrix> packedMatrices(matrices.begin(), matrices.end());
+
     unsigned int nextToCompute = s-1;
+
+    // Updates the t-values for the levels whose projections are known to be non-equidistributed
+    // when some combination of k rows has numberOfZeros trailing zeros.
+    auto update = [&](unsigned int k, unsigned int numberOfZeros)
+    {
+        for(unsigned int i = nextToCompute; i < numberOfZeros; ++i)
+        {
+            res[i] = std::max(i+1-(k-1), res[i]);
+        }
+
+        if (nextToCompute < numberOfZeros)
+        {
+            nextToCompute = numberOfZeros;
+        }
+    };
+
+    #ifdef NETBUILDER_SCHMID_WORD_KERNEL
+    if (m <= PackedGeneratingMatrix::WordSize)
+    {
+        // the updates only depend on the maximal number of trailing zeros among the combinations with k rows
+        for(unsigned int k = s ; k <= m-maxTValuesSubProj.back(); ++k)
+        {
+            forEachBatchOfCompositions(packedMatrices, k, [&](const WordLanes* rows)
+            {
+                unsigned int numberOfZeros = std::min(m, maxTrailingZeros(rows, flipingOrder.data(), (uInteger) ((1 << k) - 1)));
+                update(k, numberOfZeros);
+                return nextToCompute == m;
+            });
+            if (nextToCompute == m)
+            {
+                return res;
+            }
+        }
+        return res;
+    }
+    #endif
+
+    const unsigned int nWords = PackedGeneratingMatrix::nWords(m);
+    std::vector<Word> v(nWords);
+
     for(unsigned int k = s ; k <= m-maxTValuesSubProj.back(); ++k)
     {
         CompositionMaker compMaker(k, s);
+        std::vector<const Word*> tmp(k);
         do
         {
-            std::vector<unsigned int> comp = compMaker.currentComposition();
-            std::vector<GeneratingMatrix::Row*> tmp(k);
+            const std::vector<unsigned int>& comp = compMaker.currentComposition();
             unsigned int idx = 0;
             for(Dimension coord = 0; coord < s; ++coord)
             {
                 for(unsigned int j = 0; j < comp[coord]; ++j)
                 {
-                    tmp[idx] = &(matrices[coord][j]);
+                    tmp[idx] = packedMatrices[coord][j];
                     ++idx;
                 }
             }
 
-            boost::dynamic_bitset<> v(m);
-            unsigned int r = 0;
+            std::fill(v.begin(), v.end(), 0);
             unsigned int currentLimit = (unsigned int) ((1 << k) - 1);
-            for(unsigned int flip : flipingOrder)
+            for(unsigned int r = 0; r < currentLimit; ++r)
             {
-                v ^= *tmp[flip];
-
-                auto numberOfZeros = v.find_first();
-                
-                if (numberOfZeros == GeneratingMatrix::Row::npos)
+                const Word* row = tmp[flipingOrder[r]];
+                unsigned int numberOfZeros = m;
+                for(unsigned int w = 0; w < nWords; ++w)
                 {
-                    numberOfZeros = m;
+                    v[w] ^= row[w];
                 }
-
-                for(unsigned int i = nextToCompute; i < numberOfZeros; ++i)
+                for(unsigned int w = 0; w < nWords; ++w)
                 {
-                    res[i] = std::max(i+1-(k-1), res[i]);
+                    if (v[w])
+                    {
+                        numberOfZeros = w * PackedGeneratingMatrix::WordSize + PackedGeneratingMatrix::countTrailingZeros(v[w]);
+                        break;
+                    }
                 }
 
-                if (nextToCompute < (unsigned int) numberOfZeros)
-                {
-                    nextToCompute = (unsigned int) numberOfZeros;
-                }
+                update(k, numberOfZeros);
 
                 if (nextToCompute == m)
                 {
                     return res;
                 }
-
-                ++r;
-                if(r >= currentLimit)
-                {
-                    break;
-                }
             }
         }
         while(compMaker.goToNextComposition());
@@ -22,7 +22,12 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string/join.hpp>
 #include <iostream>
+#include <iomanip>
 #include <limits>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <algorithm>
 
 #include "netbuilder/Types.h"
 #include "netbuilder/Parser/CommandLine.h"
@@ -30,7 +35,10 @@
 #include "netbuilder/Parser/NetConstructionParser.h"
 #include "netbuilder/Parser/OutputStyleParser.h"
 #include "netbuilder/Task/Task.h"
+#include "netbuilder/FigureOfMerit/TValueComputation.h"
+#include "netbuilder/FigureOfMerit/Wafom/PointSum.h"
 
+#include "latbuilder/Parallel.h"
 #include "latbuilder/Parser/Common.h"
 #include "latbuilder/SizeParam.h"
 
@@ -39,6 +47,7 @@
 
 namespace NetBuilder{
 static unsigned int merit_digits_displayed = 0;
+static std::string shard = "";
 
 boost::program_options::options_description
 makeOptionsDescription()
@@ -75,11 +84,11 @@ makeOptionsDescription()
     "(required) exploration method; possible values:\n"
     "  evaluation:<net_description>\n" 
     "  exhaustive\n"
-    "  random:<r>\n"
+    "  random:<r>[:<stream_length>]\n"
     "  full-CBC\n"
     "  random-CBC:<r>\n"
     "  mixed-CBC:<r>:<nb_full>\n"
-    "where <net_description> is a net description (see documentation), <r> is the number of samples, and <nb_full> the number of coordinates for which full CBC exploration is used.")
+    "where <net_description> is a net description (see documentation), <r> is the number of samples, <nb_full> the number of coordinates for which full CBC exploration is used, and <stream_length> the number of samples drawn from each stream of the random generator (by default, one stream per thread; set it to obtain results which do not depend on the number of threads).")
    ("figure-of-merit,f", po::value<std::string>(),
     "(required) type of figure of merit; format: <merit>\n"
     "  and where <merit> is one of:\n"
@@ -127,6 +136,16 @@ makeOptionsDescription()
    ("repeat,r", po::value<unsigned int>()->default_value(1),
     "(optional) number of times the construction must be executed\n"
    "(can be useful to obtain different results from random constructions)\n")
+   ("shard", po::value<std::string>(),
+    "(optional) for exhaustive explorations, explore only the shard <i> out of <N> shards of the search space; format: <i>/<N>, with 0 <= <i> < <N>. The outputs of the shards can be combined with --merge-shards\n")
+   ("merge-shards", po::value<std::vector<std::string>>()->multitoken(),
+    "(optional) output folders of the shards of an exhaustive exploration; selects the best net among the outputs of the shards and copies it to the output folder, if any. All the other options except --output-folder are ignored\n")
+   ("threads", po::value<unsigned int>()->default_value(1),
+    "(optional) number of threads used to evaluate the candidates in random and CBC explorations;\n"
+   "0 for all the hardware threads (default: 1). The constructed net does not depend on the number of threads, except for random explorations without <stream_length>, whose default stream length depends on the number of threads\n")
+   ("merit-threads", po::value<unsigned int>()->default_value(0),
+    "(optional) maximal number of threads used within the evaluation of a single net by the t-value, WAFOM and coordinate-uniform computations;\n"
+   "0 for the number of hardware threads divided by the number of threads given with --threads, and at least 1 (default: 0). The merit values do not depend on the number of threads\n")
     ("verbose,v", po::value<std::string>()->default_value("0"),
    "specify the verbosity of the program;\n"
    "ranges between 0 (default) and 3\n")
@@ -157,6 +176,10 @@ parse(int argc, const char* argv[])
       std::exit (0);
    }
 
+   if (opt.count("merge-shards")) {
+      return opt;
+   }
+
    if (opt.count("weights") < 1)
       throw std::runtime_error("--weights must be specified (try --help)");
    for (const auto x : {"size", "exploration-method", "dimension", "figure-of-merit", "norm-type"}) {
@@ -182,6 +205,10 @@ cmd.s_figure = opt["figure-of-merit"].as<std::string>();\
 cmd.s_weights       = opt["weights"].as<std::vector<std::string>>();\
 cmd.m_normType = boost::lexical_cast<Real>(opt["norm-type"].as<std::string>());\
 cmd.m_interlacingFactor = opt["interlacing-factor"].as<unsigned int>(); \
+cmd.m_numThreads = opt["threads"].as<unsigned int>(); \
+if (opt.count("shard") == 1){\
+  cmd.s_shard = opt["shard"].as<std::string>();\
+}\
 interlacingFactor = cmd.m_interlacingFactor;\
 if (opt.count("combiner") < 1){\
   cmd.s_combiner = "";\
@@ -221,6 +248,9 @@ void TaskOutput(const Task::Task &task, std::string outputFolder, OutputStyle ou
     outFile.open(fileName);
     outFile << "# Input Command Line: " << boost::algorithm::join(inputCL, " ") << std::endl;
     outFile << "# Merit: " << task.outputMeritValue() << std::endl;
+    if (shard != ""){
+      outFile << "# Shard: " << shard << " - merit: " << std::setprecision(std::numeric_limits<Real>::max_digits10) << task.outputMeritValue() << std::endl;
+    }
     outFile << task.outputNet(outputStyle, interlacingFactor);
     outFile.close();
   }
@@ -231,6 +261,83 @@ void TaskOutput(const Task::Task &task, std::string outputFolder, OutputStyle ou
 }
 
 
+// selects the best output among the outputs of the shards of an exhaustive search
+void MergeShards(const std::vector<std::string>& shardFolders, std::string outputFolder)
+{
+  const std::string shardTag = "# Shard: ";
+  const std::string meritTag = " - merit: ";
+  std::string bestFile;
+  Real bestMerit = std::numeric_limits<Real>::infinity();
+  unsigned int bestShard = 0;
+  std::set<unsigned int> shards;
+  unsigned int numShards = 0;
+
+  for (const auto& folder : shardFolders){
+    const std::string fileName = folder + "/output.txt";
+    std::ifstream inFile(fileName);
+    if (!inFile){
+      throw std::runtime_error("cannot read " + fileName);
+    }
+    std::string line;
+    bool found = false;
+    while (std::getline(inFile, line)){
+      if (line.compare(0, shardTag.size(), shardTag) == 0){
+        const auto meritPos = line.find(meritTag);
+        if (meritPos == std::string::npos){
+          break;
+        }
+        auto shardAndNumShards = LatBuilder::Parser::splitPair<unsigned int, unsigned int>(line.substr(shardTag.size(), meritPos - shardTag.size()), '/', 1);
+        Real merit = boost::lexical_cast<Real>(line.substr(meritPos + meritTag.size()));
+        if (numShards != 0 && shardAndNumShards.second != numShards){
+          throw std::runtime_error(fileName + " comes from a search with a different number of shards");
+        }
+        numShards = shardAndNumShards.second;
+        shards.insert(shardAndNumShards.first);
+        // the shards are ordered as the search space: ties are broken by the index of the shard
+        if (merit < bestMerit || (merit == bestMerit && shardAndNumShards.first < bestShard) || bestFile == ""){
+          bestMerit = merit;
+          bestShard = shardAndNumShards.first;
+          bestFile = fileName;
+        }
+        found = true;
+        break;
+      }
+    }
+    if (!found){
+      throw std::runtime_error(fileName + " is not the output of a sharded search");
+    }
+  }
+  if (shards.size() != numShards){
+    std::cout << "Warning: only " << shards.size() << " out of " << numShards << " shards were merged." << std::endl;
+  }
+
+  std::ifstream bestOutput(bestFile);
+  std::stringstream content;
+  content << bestOutput.rdbuf();
+  std::cout << "====================\n       Result\n====================" << std::endl;
+  std::cout << "Best shard: " << bestShard << "/" << numShards << " (" << bestFile << ")" << std::endl;
+  std::cout << content.str();
+  if (outputFolder != ""){
+    std::ofstream outFile(outputFolder + "/output.txt");
+    outFile << content.str();
+  }
+}
+
+// number of threads used within the evaluation of a single net: by default, the hardware threads are shared
+// between the threads which evaluate the candidates, so that the machine is not oversubscribed
+unsigned int numMeritThreads(unsigned int numThreads, unsigned int meritThreads)
+{
+  if (meritThreads != 0){
+    return meritThreads;
+  }
+  const unsigned int hardwareThreads = std::max(std::thread::hardware_concurrency(), 1U);
+  if (numThreads == 0){
+    numThreads = hardwareThreads;
+  }
+  return std::max(hardwareThreads / numThreads, 1U);
+}
+
+
 int main(int argc, const char *argv[])
 {
 
@@ -252,8 +359,20 @@ int main(int argc, const char *argv[])
           }
         }
         
-        // global variable
+        if (opt.count("merge-shards") >= 1){
+          MergeShards(opt["merge-shards"].as<std::vector<std::string>>(), outputFolder);
+          return 0;
+        }
+
+        // global variables
         merit_digits_displayed = opt["merit-digits-displayed"].as<unsigned int>();
+        if (opt.count("shard") == 1){
+          shard = opt["shard"].as<std::string>();
+        }
+        const unsigned int meritThreads = numMeritThreads(opt["threads"].as<unsigned int>(), opt["merit-threads"].as<unsigned int>());
+        NetBuilder::GaussMethod::setNumThreads(meritThreads);
+        NetBuilder::FigureOfMerit::PointSum::setNumThreads(meritThreads);
+        LatBuilder::Parallel::setNumThreads(meritThreads);
 
         std::string s_multilevel = opt["multilevel"].as<std::string>();
         std::string s_construction = opt["construction"].as<std::string>();